@@ -0,0 +1,96 @@
+﻿/**
+ * @file adaptive_hatch.cpp
+ * @brief Реализация штриховки с переменным шагом.
+ */
+
+#include "adaptive_hatch.h"
+
+#include "distance_field.h"
+#include "edge_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+
+/// Шаг выборки поля вдоль линии - в долях ячейки поля.
+constexpr double SAMPLE_FRACTION = 0.5;
+
+/// Наибольший уровень линии (у линии k = 0 уровень бесконечный).
+constexpr int MAX_LEVEL = 62;
+
+double length(const Line_2& line) {
+    return std::hypot(line.end.x - line.start.x, line.end.y - line.start.y);
+}
+
+} // namespace
+
+void hatchAdaptive(const Contours& contours, double angleDegrees, const AdaptiveStepOptions& options, Lines& lines,
+    AdaptiveHatchStats* stats, std::pmr::memory_resource* scratch) {
+    if (!(options.minStep > 0) || !(options.maxStep >= options.minStep))
+        throw std::invalid_argument("Adaptive step requires 0 < min step <= max step");
+
+    double minStep = options.minStep;
+    double falloff = options.falloff > 0 ? options.falloff : options.maxStep;
+    auto spacing = [&](double d) {
+        return minStep + (options.maxStep - minStep) * std::min(d / falloff, 1.0);
+    };
+
+    EdgeIndex index(contours, angleDegrees, 0, scratch);
+    DistanceField field(contours, minStep, scratch);
+    double sample = field.cellSize() * SAMPLE_FRACTION;
+
+    AdaptiveHatchStats local;
+    local.fieldCells = field.columns() * field.rows();
+
+    std::pmr::vector<double> crossings(scratch);
+    Lines row(scratch);
+    auto first = static_cast<std::int64_t>(std::ceil(index.minOffset() / minStep));
+    auto last = static_cast<std::int64_t>(std::floor(index.maxOffset() / minStep));
+    for (std::int64_t k = first; k <= last; ++k) {
+        row.clear();
+        hatchRow(index, static_cast<double>(k) * minStep, crossings, row);
+
+        int level = k == 0 ? MAX_LEVEL : std::countr_zero(static_cast<std::uint64_t>(k < 0 ? -k : k));
+        // Линия нужна, пока требуемый шаг меньше minStep * 2^(level+1).
+        double limit = std::ldexp(minStep, std::min(level, MAX_LEVEL) + 1);
+
+        for (const auto& piece : row) {
+            double pieceLength = length(piece);
+            local.uniformLength += pieceLength;
+
+            // Выборка поля вдоль отрезка; граница зоны - посередине между выборками.
+            auto samples = static_cast<std::size_t>(std::ceil(pieceLength / sample));
+            auto pointAt = [&](double t) {
+                return Point_2{ piece.start.x + (piece.end.x - piece.start.x) * t,
+                                piece.start.y + (piece.end.y - piece.start.y) * t };
+            };
+            auto needed = [&](std::size_t s) {
+                double t = samples > 0 ? static_cast<double>(s) / static_cast<double>(samples) : 0;
+                return spacing(field.at(pointAt(t))) < limit;
+            };
+
+            auto emit = [&](const Point_2& a, const Point_2& b) {
+                lines.push_back({ a, b });
+                local.adaptiveLength += length(lines.back());
+            };
+
+            bool inside = needed(0);
+            double enter = 0;
+            for (std::size_t s = 1; s <= samples; ++s) {
+                bool keep = needed(s);
+                if (keep == inside) continue;
+                double t = (static_cast<double>(s) - 0.5) / static_cast<double>(samples);
+                if (keep) enter = t;
+                else emit(pointAt(enter), pointAt(t));
+                inside = keep;
+            }
+            if (inside) emit(pointAt(enter), piece.end);
+        }
+    }
+
+    if (stats) *stats = local;
+}
@@ -0,0 +1,61 @@
+﻿/**
+ * @file adaptive_hatch.h
+ * @brief Штриховка с переменным шагом по полю плотности.
+ *
+ * Густая штриховка нужна у края детали (качество кромки), а в глубине
+ * достаточно редкой. Требуемый шаг в точке задаётся расстоянием до контура:
+ *
+ *     spacing(d) = minStep + (maxStep - minStep) * min(d / falloff, 1)
+ *
+ * Расстояние берётся из DistanceField, посчитанного один раз на задание.
+ *
+ * Линии идут с шагом minStep и смещениями k * minStep (как в hatchWithIndex),
+ * а каждой линии назначен уровень - число младших нулевых битов k. Линия
+ * уровня L проводится только там, где требуемый шаг меньше minStep * 2^(L+1):
+ * где шаг вырос вдвое, выпадает каждая вторая линия, вчетверо - три из
+ * четырёх, и т.д. Итоговый шаг - наибольшее minStep * 2^L, не превышающее
+ * требуемого; оставшиеся линии продолжаются без разрывов между зонами.
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <memory_resource>
+
+/**
+ * @brief Параметры переменного шага.
+ */
+struct AdaptiveStepOptions {
+    /// Шаг у контура.
+    double minStep = 1;
+    /// Наибольший шаг в глубине области.
+    double maxStep = 4;
+    /// Расстояние от контура, на котором шаг достигает maxStep; 0 - maxStep.
+    double falloff = 0;
+};
+
+/**
+ * @brief Итоги построения.
+ */
+struct AdaptiveHatchStats {
+    /// Длина штриховки с постоянным шагом minStep.
+    double uniformLength = 0;
+    /// Длина штриховки с переменным шагом.
+    double adaptiveLength = 0;
+    /// Ячеек поля расстояний.
+    std::size_t fieldCells = 0;
+};
+
+/**
+ * @brief Штрихует область (правило чётности) с переменным шагом.
+ * @param contours Контуры.
+ * @param angleDegrees Угол штриховки в градусах.
+ * @param options Параметры шага.
+ * @param lines Выходные линии (дописываются).
+ * @param stats Итоги (необязательно).
+ * @param scratch Источник памяти для индекса рёбер и поля расстояний.
+ * @throws std::invalid_argument если minStep <= 0 или maxStep < minStep.
+ */
+void hatchAdaptive(const Contours& contours, double angleDegrees, const AdaptiveStepOptions& options, Lines& lines,
+    AdaptiveHatchStats* stats = nullptr, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
@@ -0,0 +1,222 @@
+﻿/**
+ * @file batch_pipeline.cpp
+ * @brief Реализация конвейерной пакетной обработки.
+ */
+
+#include "batch_pipeline.h"
+#include "concurrent_queue.h"
+#include "curves.h"
+#include "dxf_reader.h"
+#include "fill_pattern.h"
+#include "hatcher.h"
+#include "job_arena.h"
+#include "offset.h"
+#include "perimeter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Задание в пути между стадиями. Пустой указатель - признак конца потока.
+ *
+ * Вся геометрия задания (контуры, линии, временные структуры штриховки)
+ * размещается в его арене; после записи арена сбрасывается и достаётся
+ * следующему заданию.
+ */
+struct BatchJob {
+    explicit BatchJob(std::unique_ptr<JobArena> jobArena)
+        : arena(std::move(jobArena)), contours(arena.get()), perimeters(arena.get()), lines(arena.get()) {}
+
+    std::unique_ptr<JobArena> arena;
+    std::size_t sequence = 0;
+    const BatchItem* item = nullptr;
+    Contours contours;
+    Polylines perimeters;
+    Lines lines;
+    std::string error;
+};
+
+using JobPtr = std::unique_ptr<BatchJob>;
+
+} // namespace
+
+std::vector<BatchItem> readBatchList(const std::string& listPath, OutputFormat format) {
+    std::ifstream in(listPath);
+    if (!in)
+        throw std::runtime_error("cannot open batch list " + listPath);
+
+    std::vector<BatchItem> items;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        BatchItem item;
+        std::size_t tab = line.find('\t');
+        item.inputPath = line.substr(0, tab);
+        if (tab != std::string::npos) {
+            item.outputPath = line.substr(tab + 1);
+        }
+        else {
+            std::filesystem::path output(item.inputPath);
+            output.replace_extension(format == OutputFormat::Svg ? ".svg" : ".bin");
+            item.outputPath = output.string();
+        }
+        items.push_back(std::move(item));
+    }
+    return items;
+}
+
+BatchReport runBatchPipeline(const std::vector<BatchItem>& items, const BatchOptions& options) {
+    std::size_t hatchThreads = options.hatchThreads;
+    if (hatchThreads == 0) hatchThreads = std::max(1u, std::thread::hardware_concurrency());
+    double tolerance = options.tolerance > 0 ? options.tolerance : flatteningToleranceForStep(options.step);
+    std::unique_ptr<FillPattern> pattern;
+    if (options.pattern != "lines") pattern = makeFillPattern(options.pattern, options.angleDegrees, options.density);
+
+    MpmcQueue<JobPtr> toHatch(options.queueCapacity);
+    MpmcQueue<JobPtr> toOrder(options.queueCapacity);
+    SpscQueue<JobPtr> toWrite(options.queueCapacity);
+
+    // Арен ровно столько, сколько заданий может одновременно находиться в конвейере:
+    // чтение ждёт свободную арену, так что память пакета ограничена сверху.
+    std::size_t arenaCount = options.queueCapacity * 3 + hatchThreads + 2;
+    SpscQueue<std::unique_ptr<JobArena>> freeArenas(arenaCount);
+    for (std::size_t i = 0; i < arenaCount; ++i)
+        freeArenas.push(std::make_unique<JobArena>());
+
+    BatchReport report;
+    std::vector<Clock::duration> hatchBusy(hatchThreads, Clock::duration::zero());
+    auto start = Clock::now();
+
+    // --- Чтение ---
+    std::thread reader([&] {
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            auto job = std::make_unique<BatchJob>(freeArenas.pop());
+            job->sequence = i;
+            job->item = &items[i];
+
+            auto begin = Clock::now();
+            try {
+                job->contours = readDxfFile(items[i].inputPath, tolerance, job->arena.get());
+            }
+            catch (const std::exception& e) {
+                job->error = e.what();
+            }
+            report.readTime += Clock::now() - begin;
+
+            toHatch.push(std::move(job));
+        }
+        for (std::size_t i = 0; i < hatchThreads; ++i)
+            toHatch.push(nullptr);
+    });
+
+    // --- Штриховка ---
+    std::vector<std::thread> hatchers;
+    for (std::size_t t = 0; t < hatchThreads; ++t) {
+        hatchers.emplace_back([&, t] {
+            while (JobPtr job = toHatch.pop()) {
+                auto begin = Clock::now();
+                if (job->error.empty()) {
+                    try {
+                        // Область заполнения: внутри периметров, с отступом или весь контур.
+                        Contours infill(job->arena.get());
+                        if (options.perimeters > 0) {
+                            PerimeterOptions perimeterOptions;
+                            perimeterOptions.count = options.perimeters;
+                            perimeterOptions.spacing =
+                                options.perimeterSpacing > 0 ? options.perimeterSpacing : options.step;
+                            perimeterOptions.inset = options.inset;
+                            job->perimeters = generatePerimeters(job->contours, perimeterOptions, &infill, job->arena.get());
+                        }
+                        else if (options.inset != 0) {
+                            infill = offsetContours(job->contours, -options.inset, {}, nullptr, job->arena.get());
+                        }
+                        const Contours& area = options.perimeters > 0 || options.inset != 0 ? infill : job->contours;
+
+                        // Узор общий для всех заданий: решётки развёртываются один раз на пакет.
+                        if (pattern) pattern->fill(area, options.step, job->perimeters);
+                        else hatchContours(area, options.angleDegrees, options.step, job->lines, job->arena.get());
+                    }
+                    catch (const std::exception& e) {
+                        job->error = e.what();
+                    }
+                }
+                hatchBusy[t] += Clock::now() - begin;
+                toOrder.push(std::move(job));
+            }
+            toOrder.push(nullptr);
+        });
+    }
+
+    // --- Упорядочивание ---
+    std::thread orderer([&] {
+        std::map<std::size_t, JobPtr> pending;
+        std::size_t next = 0;
+        std::size_t finished = 0;
+
+        while (finished < hatchThreads) {
+            JobPtr job = toOrder.pop();
+            if (!job) {
+                ++finished;
+                continue;
+            }
+            pending.emplace(job->sequence, std::move(job));
+            for (auto it = pending.find(next); it != pending.end(); it = pending.find(++next)) {
+                toWrite.push(std::move(it->second));
+                pending.erase(it);
+            }
+        }
+        toWrite.push(nullptr);
+    });
+
+    // --- Запись ---
+    std::thread writer([&] {
+        while (JobPtr job = toWrite.pop()) {
+            auto begin = Clock::now();
+            ++report.jobs;
+
+            if (job->error.empty()) {
+                std::ofstream out(job->item->outputPath, std::ios::binary);
+                if (options.format == OutputFormat::Svg) writeSvg(out, job->perimeters, job->lines, job->contours);
+                else writeBinary(out, job->lines, job->perimeters);
+                if (!out) job->error = "cannot write " + job->item->outputPath;
+                report.lines += job->lines.size();
+                report.polylines += job->perimeters.size();
+                for (const auto& polyline : job->perimeters) report.points += polyline.size();
+            }
+
+            if (!job->error.empty()) {
+                ++report.failed;
+                report.errors.push_back(job->item->inputPath + ": " + job->error);
+            }
+
+            // Контейнеры задания уничтожаются до сброса арены.
+            std::unique_ptr<JobArena> arena = std::move(job->arena);
+            job.reset();
+            report.arenaPeakBytes = std::max(report.arenaPeakBytes, arena->peakBytes());
+            arena->reset();
+            freeArenas.push(std::move(arena));
+
+            report.writeTime += Clock::now() - begin;
+        }
+    });
+
+    reader.join();
+    for (auto& hatcher : hatchers) hatcher.join();
+    orderer.join();
+    writer.join();
+
+    report.elapsed = Clock::now() - start;
+    for (const auto& busy : hatchBusy) report.hatchTime += busy;
+    return report;
+}
@@ -0,0 +1,98 @@
+﻿/**
+ * @file batch_pipeline.h
+ * @brief Конвейерная пакетная обработка: чтение -> штриховка -> упорядочивание -> запись.
+ *
+ * Стадии работают в своих потоках и связаны ограниченными неблокирующими
+ * очередями: чтение (1 поток) -> MPMC -> штриховка (N потоков) -> MPMC ->
+ * упорядочивание (1 поток) -> SPSC -> запись (1 поток). Пока одно задание
+ * штрихуется, следующее уже читается, а предыдущее пишется, поэтому время
+ * пакета определяется самой медленной стадией, а не суммой стадий.
+ * Упорядочивание восстанавливает исходный порядок заданий перед записью.
+ */
+
+#pragma once
+
+#include "lattice_pattern.h"
+#include "output_writers.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Одно задание пакета.
+ */
+struct BatchItem {
+    /// Входной DXF-файл.
+    std::string inputPath;
+    /// Выходной файл.
+    std::string outputPath;
+};
+
+/**
+ * @brief Параметры конвейера.
+ */
+struct BatchOptions {
+    double angleDegrees = 45;
+    double step = 1;
+    /// Точность аппроксимации дуг; 0 - по шагу.
+    double tolerance = 0;
+    /// Отступ штриховки внутрь контура (радиус пятна/инструмента); 0 - без отступа.
+    double inset = 0;
+    /// Число периметров перед штриховкой.
+    std::size_t perimeters = 0;
+    /// Расстояние между периметрами; 0 - шаг штриховки.
+    double perimeterSpacing = 0;
+    /// Узор заполнения (makeFillPattern); lines - обычная штриховка.
+    std::string pattern = "lines";
+    /// Доля площади под дорожками для решёток.
+    double density = DEFAULT_LATTICE_DENSITY;
+    OutputFormat format = OutputFormat::Svg;
+    /// Число потоков штриховки; 0 - по числу ядер.
+    std::size_t hatchThreads = 0;
+    /// Ёмкость каждой очереди между стадиями.
+    std::size_t queueCapacity = 16;
+};
+
+/**
+ * @brief Итоги пакета.
+ */
+struct BatchReport {
+    std::size_t jobs = 0;
+    std::size_t failed = 0;
+    std::size_t lines = 0;
+    /// Ломаные (периметры и траектории узора) и их точки.
+    std::size_t polylines = 0;
+    std::size_t points = 0;
+    std::chrono::duration<double> elapsed{ 0 };
+    /// Суммарное время работы стадий (для штриховки - по всем потокам).
+    std::chrono::duration<double> readTime{ 0 };
+    std::chrono::duration<double> hatchTime{ 0 };
+    std::chrono::duration<double> writeTime{ 0 };
+    /// Пиковый объём арены одного задания (контуры, линии и временные структуры).
+    std::size_t arenaPeakBytes = 0;
+    /// Сообщения об ошибках в порядке заданий.
+    std::vector<std::string> errors;
+};
+
+/**
+ * @brief Читает список заданий.
+ *
+ * Одна строка - одно задание: путь к DXF и, через табуляцию, путь результата.
+ * Без второго поля результат пишется рядом с входом с расширением формата.
+ *
+ * @param listPath Файл списка.
+ * @param format Формат результата (для имени по умолчанию).
+ * @return Задания.
+ * @throws std::runtime_error если список не открывается.
+ */
+std::vector<BatchItem> readBatchList(const std::string& listPath, OutputFormat format);
+
+/**
+ * @brief Выполняет пакет заданий конвейером.
+ * @param items Задания.
+ * @param options Параметры.
+ * @return Итоги.
+ */
+BatchReport runBatchPipeline(const std::vector<BatchItem>& items, const BatchOptions& options);
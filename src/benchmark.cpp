@@ -0,0 +1,347 @@
+﻿/**
+ * @file benchmark.cpp
+ * @brief Реализация встроенных замеров производительности.
+ */
+
+#include "benchmark.h"
+#include "dxf_reader.h"
+#include "hatcher.h"
+#include "offset.h"
+#include "robust_predicates.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <numbers>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Число прогонов каждого замера; в отчёт идёт лучший.
+constexpr int REPEATS = 3;
+
+/**
+ * @brief Время лучшего из REPEATS прогонов в миллисекундах.
+ */
+template <typename F>
+double bestOf(F&& run) {
+    double best = 0;
+    for (int r = 0; r < REPEATS; ++r) {
+        auto begin = Clock::now();
+        run();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+        best = r == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+std::size_t vertexCount(const Contours& contours) {
+    std::size_t count = 0;
+    for (const auto& contour : contours) count += contour.size();
+    return count;
+}
+
+/**
+ * @brief Сетка side x side окружностей радиуса 0.4 с шагом 1 (по vertices вершин),
+ * в каждой - отверстие радиуса 0.2.
+ */
+Contours ringGrid(std::size_t side, std::size_t vertices) {
+    Contours contours;
+    for (std::size_t row = 0; row < side; ++row) {
+        for (std::size_t col = 0; col < side; ++col) {
+            for (double radius : { 0.4, 0.2 }) {
+                Contour contour;
+                for (std::size_t k = 0; k < vertices; ++k) {
+                    double a = 2 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(vertices);
+                    contour.push_back({ static_cast<double>(col) + radius * std::cos(a),
+                                        static_cast<double>(row) + radius * std::sin(a) });
+                }
+                contours.push_back(std::move(contour));
+            }
+        }
+    }
+    return contours;
+}
+
+/**
+ * @brief Сетка самопересекающихся звёзд {points/3} (каждая - один контур).
+ */
+Contours starGrid(std::size_t side, std::size_t points) {
+    Contours contours;
+    for (std::size_t row = 0; row < side; ++row) {
+        for (std::size_t col = 0; col < side; ++col) {
+            Contour contour;
+            for (std::size_t k = 0; k < points; ++k) {
+                double a = 2 * std::numbers::pi * static_cast<double>(k * 3 % points) / static_cast<double>(points);
+                contour.push_back({ static_cast<double>(col) + 0.45 * std::cos(a),
+                                    static_cast<double>(row) + 0.45 * std::sin(a) });
+            }
+            contours.push_back(std::move(contour));
+        }
+    }
+    return contours;
+}
+
+void benchmarkOffset(std::ostream& out) {
+    struct Case {
+        const char* name;
+        Contours contours;
+    };
+    Case cases[] = {
+        { "rings 10x10x64", ringGrid(10, 64) },
+        { "rings 40x40x64", ringGrid(40, 64) },
+        { "rings 20x20x256", ringGrid(20, 256) },
+        { "stars 20x20x32", starGrid(20, 32) },
+    };
+
+    out << std::left << std::setw(20) << "set" << std::setw(10) << "vertices" << std::setw(8) << "delta"
+        << std::setw(8) << "join" << std::setw(12) << "ms" << std::setw(10) << "raw" << std::setw(12)
+        << "crossings" << "contours\n";
+
+    for (const auto& c : cases) {
+        for (double delta : { -0.05, 0.15 }) {
+            for (JoinType join : { JoinType::Round, JoinType::Miter }) {
+                OffsetOptions options;
+                options.join = join;
+                OffsetStats stats;
+                double ms = bestOf([&] { offsetContours(c.contours, delta, options, &stats); });
+                out << std::setw(20) << c.name << std::setw(10) << vertexCount(c.contours) << std::setw(8) << delta
+                    << std::setw(8) << (join == JoinType::Round ? "round" : "miter") << std::setw(12) << ms
+                    << std::setw(10) << stats.rawEdges << std::setw(12) << stats.intersections
+                    << stats.contours << "\n";
+            }
+        }
+    }
+}
+
+/// Вершина LWPOLYLINE: координаты и bulge исходящего сегмента.
+struct DxfPoint {
+    double x;
+    double y;
+    double bulge;
+};
+
+/// Замкнутая LWPOLYLINE (или POLYLINE/VERTEX при legacy).
+std::string dxfPolyline(const std::vector<DxfPoint>& points, bool legacy = false) {
+    std::ostringstream out;
+    if (legacy) {
+        out << "0\nPOLYLINE\n70\n1\n";
+        for (const auto& p : points)
+            out << "0\nVERTEX\n10\n" << p.x << "\n20\n" << p.y << "\n42\n" << p.bulge << "\n";
+        out << "0\nSEQEND\n";
+    }
+    else {
+        out << "0\nLWPOLYLINE\n90\n" << points.size() << "\n70\n1\n";
+        for (const auto& p : points)
+            out << "10\n" << p.x << "\n20\n" << p.y << "\n42\n" << p.bulge << "\n";
+    }
+    return out.str();
+}
+
+std::string dxfDocument(const std::string& entities) {
+    return "0\nSECTION\n2\nENTITIES\n" + entities + "0\nENDSEC\n0\nEOF\n";
+}
+
+double contoursArea(const Contours& contours) {
+    double area = 0;
+    for (const auto& contour : contours) {
+        double twice = 0;
+        for (std::size_t i = 0; i < contour.size(); ++i) {
+            const Point_2& a = contour[i];
+            const Point_2& b = contour[(i + 1) % contour.size()];
+            twice += a.x * b.y - b.x * a.y;
+        }
+        area += std::abs(twice) / 2;
+    }
+    return area;
+}
+
+/**
+ * @brief Чтение DXF: число контуров и площадь на эталонных входах, затем скорость.
+ *
+ * Окружность CAD записывает замкнутой LWPOLYLINE из двух вершин с bulge 1;
+ * она должна читаться как контур, а отрезок из двух вершин без дуг - нет.
+ */
+void benchmarkDxf(std::ostream& out) {
+    constexpr double TOLERANCE = 1e-4;
+    const double pi = std::numbers::pi;
+    std::string circles;
+    for (int i = 0; i < 2000; ++i) {
+        double x = (i % 100) * 3.0, y = (i / 100) * 3.0;
+        circles += dxfPolyline({ { x, y, 1 }, { x + 2, y, 1 } });
+    }
+
+    struct Case {
+        const char* name;
+        std::string document;
+        std::size_t contours;
+        double area;
+    };
+    Case cases[] = {
+        { "square", dxfDocument(dxfPolyline({ { 0, 0, 0 }, { 10, 0, 0 }, { 10, 10, 0 }, { 0, 10, 0 } })), 1, 100 },
+        { "slot", dxfDocument(dxfPolyline({ { 0, 0, 0 }, { 10, 0, 1 }, { 10, 4, 0 }, { 0, 4, 1 } })), 1, 40 + 4 * pi },
+        { "circle", dxfDocument(dxfPolyline({ { 0, 0, 1 }, { 10, 0, 1 } })), 1, 25 * pi },
+        { "circle (POLYLINE)", dxfDocument(dxfPolyline({ { 0, 0, 1 }, { 10, 0, 1 } }, true)), 1, 25 * pi },
+        { "two-point line", dxfDocument(dxfPolyline({ { 0, 0, 0 }, { 10, 0, 0 } })), 0, 0 },
+        { "circles 2000", dxfDocument(circles), 2000, 2000 * pi },
+    };
+
+    out << std::left << std::setw(20) << "set" << std::setw(10) << "contours" << std::setw(14) << "area"
+        << std::setw(14) << "expected" << "ms\n";
+    for (const auto& c : cases) {
+        Contours contours;
+        double ms = bestOf([&] {
+            contours.clear();
+            std::istringstream in(c.document);
+            readDxfContours(in, TOLERANCE, [&](Contour&& contour) { contours.push_back(std::move(contour)); });
+        });
+        double area = contoursArea(contours);
+        out << std::setw(20) << c.name << std::setw(10) << contours.size() << std::setw(14) << area
+            << std::setw(14) << c.area << ms << "\n";
+        if (contours.size() != c.contours || std::abs(area - c.area) > 1e-3 * std::max(c.area, 1.0))
+            throw std::runtime_error(std::string("DXF benchmark: unexpected contours for ") + c.name);
+    }
+}
+
+/**
+ * @brief Предикат ориентации: проверка знака на почти коллинеарных точках и цена фильтра.
+ *
+ * Сетка Шевчука: a = (0.5 + i * 2^-53, 0.5 + j * 2^-53), b = (12, 12),
+ * c = (24, 24). Точный определитель равен 12 * (ay - ax), то есть знак -
+ * sign(j - i); наивная формула в double часто ошибается. Ошибка orient2d
+ * на сетке - исключение.
+ */
+void benchmarkPredicates(std::ostream& out) {
+    constexpr int SIDE = 256;
+    const Point_2 b{ 12, 12 };
+    const Point_2 c{ 24, 24 };
+    auto naive = [](const Point_2& a, const Point_2& b, const Point_2& c) {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    };
+    auto sign = [](double v) { return (v > 0) - (v < 0); };
+
+    resetPredicateStats();
+    std::size_t robustWrong = 0;
+    std::size_t naiveWrong = 0;
+    for (int i = 0; i < SIDE; ++i) {
+        for (int j = 0; j < SIDE; ++j) {
+            Point_2 a{ 0.5 + i * 0x1p-53, 0.5 + j * 0x1p-53 };
+            int exact = (j > i) - (j < i);
+            if (sign(orient2d(a, b, c)) != exact) ++robustWrong;
+            if (sign(naive(a, b, c)) != exact) ++naiveWrong;
+        }
+    }
+    PredicateStats grid = predicateStats();
+
+    // Случайные точки общего положения: почти все вызовы проходят фильтр.
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> coordinate(-100, 100);
+    std::vector<Point_2> points(300000);
+    for (auto& p : points) p = { coordinate(random), coordinate(random) };
+    double sum = 0;
+    resetPredicateStats();
+    for (std::size_t k = 0; k + 2 < points.size(); ++k) sum += orient2d(points[k], points[k + 1], points[k + 2]);
+    PredicateStats general = predicateStats();
+    double robustMs = bestOf([&] {
+        for (std::size_t k = 0; k + 2 < points.size(); ++k) sum += orient2d(points[k], points[k + 1], points[k + 2]);
+    });
+    double naiveMs = bestOf([&] {
+        for (std::size_t k = 0; k + 2 < points.size(); ++k) sum += naive(points[k], points[k + 1], points[k + 2]);
+    });
+
+    out << std::left << std::setw(24) << "set" << std::setw(12) << "fallbacks" << std::setw(14) << "wrong signs"
+        << std::setw(14) << "naive wrong" << std::setw(12) << "ms" << std::setw(12) << "naive ms" << "ratio\n";
+    out << std::setw(24) << "near-collinear 256x256" << std::setw(12) << grid.fallbacks << std::setw(14) << robustWrong
+        << std::setw(14) << naiveWrong << std::setw(12) << "-" << std::setw(12) << "-" << "-\n";
+    out << std::setw(24) << "random 300000" << std::setw(12) << general.fallbacks << std::setw(14) << "-"
+        << std::setw(14) << "-" << std::setw(12) << robustMs << std::setw(12) << naiveMs << robustMs / naiveMs << "\n";
+    // Сумма не даёт компилятору выбросить замеряемые циклы.
+    if (!std::isfinite(sum)) out << "(non-finite checksum)\n";
+
+    if (robustWrong > 0) throw std::runtime_error("Predicate benchmark: orient2d returned a wrong sign");
+}
+
+/**
+ * @brief Прежняя штриховка прямоугольника: отрезок длиной в диагональ на каждую строку и clipLine.
+ */
+void hatchRectangleByClipping(const Point_2& bottomLeft, const Point_2& topRight, double angleDegrees, double step,
+    Lines& lines) {
+    double angleRadians = degreesToRadians(angleDegrees);
+    double width = topRight.x - bottomLeft.x;
+    double height = topRight.y - bottomLeft.y;
+    double diagonal = std::sqrt(width * width + height * height);
+    Point_2 center{ (bottomLeft.x + topRight.x) / 2, (bottomLeft.y + topRight.y) / 2 };
+    Point_2 dir{ std::cos(angleRadians), std::sin(angleRadians) };
+    Point_2 perp{ -dir.y, dir.x };
+
+    for (double offset = -diagonal / 2; offset <= diagonal / 2; offset += step) {
+        Line_2 line;
+        line.start = { center.x + perp.x * offset - dir.x * diagonal / 2,
+                       center.y + perp.y * offset - dir.y * diagonal / 2 };
+        line.end = { center.x + perp.x * offset + dir.x * diagonal / 2,
+                     center.y + perp.y * offset + dir.y * diagonal / 2 };
+        if (clipLine(line, bottomLeft, topRight))
+            lines.push_back(line);
+    }
+}
+
+/// Наибольшее расхождение концов двух наборов линий (одинаковой длины).
+double maxDeviation(const Lines& a, const Lines& b) {
+    double deviation = 0;
+    for (std::size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+        deviation = std::max({ deviation,
+            std::hypot(a[i].start.x - b[i].start.x, a[i].start.y - b[i].start.y),
+            std::hypot(a[i].end.x - b[i].end.x, a[i].end.y - b[i].end.y) });
+    }
+    return deviation;
+}
+
+void benchmarkRectangle(std::ostream& out) {
+    const Point_2 bottomLeft{ 0, 0 };
+    const Point_2 topRight{ 200, 100 };
+    constexpr double STEP = 0.005;
+
+    out << std::left << std::setw(8) << "angle" << std::setw(8) << "as" << std::setw(10) << "lines"
+        << std::setw(14) << "clipLine ms" << std::setw(14) << "hatch ms" << std::setw(10) << "speedup"
+        << "max deviation\n";
+
+    // Углы, равные особым по модулю 180, должны попадать на быстрые пути.
+    for (double angle : { 15.0, 30.0, 45.0, 60.0, 135.0, 0.0, 90.0, 180.0, 270.0, -90.0, 360.0, 225.0, -45.0 }) {
+        Lines clipped;
+        Lines hatched;
+        double clipMs = bestOf([&] {
+            clipped.clear();
+            hatchRectangleByClipping(bottomLeft, topRight, angle, STEP, clipped);
+        });
+        double hatchMs = bestOf([&] {
+            hatched.clear();
+            hatchRectangle(bottomLeft, topRight, angle, STEP, hatched);
+        });
+
+        out << std::setw(8) << angle << std::setw(8) << normalizeHatchAngle(angle) << std::setw(10) << hatched.size()
+            << std::setw(14) << clipMs << std::setw(14) << hatchMs << std::setw(10) << clipMs / hatchMs;
+        // Осевые пути начинают строки от края, а не от центра, и проходят их в приведённом
+        // направлении: поточечно сравнимы только совпадающие наборы.
+        if (clipped.size() == hatched.size() && normalizeHatchAngle(angle) == angle && angle != 0 && angle != 90)
+            out << maxDeviation(clipped, hatched) << "\n";
+        else
+            out << "-\n";
+    }
+}
+
+} // namespace
+
+void runBenchmark(const std::string& name, std::ostream& out) {
+    if (name == "offset") benchmarkOffset(out);
+    else if (name == "rectangle") benchmarkRectangle(out);
+    else if (name == "dxf") benchmarkDxf(out);
+    else if (name == "predicates") benchmarkPredicates(out);
+    else throw std::invalid_argument("Unknown benchmark: " + name);
+}
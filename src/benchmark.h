@@ -0,0 +1,25 @@
+﻿/**
+ * @file benchmark.h
+ * @brief Встроенные замеры производительности (`--bench <набор>`).
+ *
+ * Замеры работают на синтетических данных, не требуют внешних файлов и
+ * печатают таблицу: вход, время лучшего из нескольких прогонов, счётчики.
+ */
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+/**
+ * @brief Запускает набор замеров.
+ * @param name Имя набора: `offset` (эквидистанта), `rectangle` (штриховка
+ *             прямоугольника против прежней обрезки clipLine), `dxf` (чтение
+ *             эталонных DXF, в том числе окружностей из двух дуг),
+ *             `predicates` (знак orient2d на почти коллинеарных точках
+ *             против точного и доля уточнений).
+ * @param out Поток для отчёта.
+ * @throws std::invalid_argument для неизвестного набора.
+ * @throws std::runtime_error если результат набора не совпал с эталоном.
+ */
+void runBenchmark(const std::string& name, std::ostream& out);
@@ -0,0 +1,195 @@
+﻿/**
+ * @file concurrent_queue.h
+ * @brief Ограниченные неблокирующие очереди для связи стадий конвейера.
+ *
+ * - SpscQueue - кольцевой буфер для одного производителя и одного потребителя;
+ * - MpmcQueue - очередь Вьюкова для многих производителей и потребителей.
+ *
+ * Обе очереди фиксированного размера (степень двойки) и не выделяют память
+ * после создания. tryPush/tryPop не блокируются; push/pop ждут, уступая
+ * процессор, пока в очереди не появится место или элемент.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace queue_detail {
+
+/// Размер строки кэша, по которому разносятся индексы производителя и потребителя.
+constexpr std::size_t CACHE_LINE = 64;
+
+inline std::size_t roundUpToPowerOfTwo(std::size_t value) {
+    std::size_t result = 2;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+/**
+ * @brief Ожидание с нарастающей уступкой процессора.
+ *
+ * Сначала короткое вращение, затем yield, а при долгом простое стадии -
+ * короткий сон, чтобы ожидающий поток не занимал ядро.
+ */
+class Backoff {
+public:
+    void pause() {
+        ++spins_;
+        if (spins_ > 1024) std::this_thread::sleep_for(std::chrono::microseconds(50));
+        else if (spins_ > 64) std::this_thread::yield();
+    }
+
+private:
+    unsigned spins_ = 0;
+};
+
+} // namespace queue_detail
+
+/**
+ * @brief Очередь для одного производителя и одного потребителя.
+ * @tparam T Тип элемента (перемещаемый, конструируемый по умолчанию).
+ */
+template <typename T>
+class SpscQueue {
+public:
+    /**
+     * @brief Создаёт очередь.
+     * @param capacity Минимальная ёмкость (округляется до степени двойки).
+     */
+    explicit SpscQueue(std::size_t capacity)
+        : mask_(queue_detail::roundUpToPowerOfTwo(capacity) - 1),
+          slots_(std::make_unique<T[]>(mask_ + 1)) {}
+
+    /// Пытается добавить элемент; false, если очередь полна.
+    bool tryPush(T& value) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_) return false;
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Пытается извлечь элемент; false, если очередь пуста.
+    bool tryPop(T& value) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Добавляет элемент, ожидая свободного места.
+    void push(T value) {
+        queue_detail::Backoff backoff;
+        while (!tryPush(value)) backoff.pause();
+    }
+
+    /// Извлекает элемент, ожидая его появления.
+    T pop() {
+        T value;
+        queue_detail::Backoff backoff;
+        while (!tryPop(value)) backoff.pause();
+        return value;
+    }
+
+private:
+    const std::size_t mask_;
+    std::unique_ptr<T[]> slots_;
+    alignas(queue_detail::CACHE_LINE) std::atomic<std::size_t> head_{ 0 };
+    alignas(queue_detail::CACHE_LINE) std::atomic<std::size_t> tail_{ 0 };
+};
+
+/**
+ * @brief Очередь для многих производителей и потребителей (алгоритм Вьюкова).
+ * @tparam T Тип элемента (перемещаемый, конструируемый по умолчанию).
+ */
+template <typename T>
+class MpmcQueue {
+public:
+    /**
+     * @brief Создаёт очередь.
+     * @param capacity Минимальная ёмкость (округляется до степени двойки).
+     */
+    explicit MpmcQueue(std::size_t capacity)
+        : mask_(queue_detail::roundUpToPowerOfTwo(capacity) - 1),
+          cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+        for (std::size_t i = 0; i <= mask_; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /// Пытается добавить элемент; false, если очередь полна.
+    bool tryPush(T& value) {
+        std::size_t pos = enqueue_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Пытается извлечь элемент; false, если очередь пуста.
+    bool tryPop(T& value) {
+        std::size_t pos = dequeue_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = dequeue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Добавляет элемент, ожидая свободного места.
+    void push(T value) {
+        queue_detail::Backoff backoff;
+        while (!tryPush(value)) backoff.pause();
+    }
+
+    /// Извлекает элемент, ожидая его появления.
+    T pop() {
+        T value;
+        queue_detail::Backoff backoff;
+        while (!tryPop(value)) backoff.pause();
+        return value;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(queue_detail::CACHE_LINE) std::atomic<std::size_t> enqueue_{ 0 };
+    alignas(queue_detail::CACHE_LINE) std::atomic<std::size_t> dequeue_{ 0 };
+};
@@ -0,0 +1,176 @@
+﻿/**
+ * @file curves.cpp
+ * @brief Адаптивная аппроксимация дуг и кривых Безье.
+ */
+
+#include "curves.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/// Предел числа сегментов на одну кривую (защита от вырожденной точности).
+constexpr int MAX_CURVE_SEGMENTS = 4096;
+
+double length(double x, double y) { return std::sqrt(x * x + y * y); }
+
+/**
+ * @brief Число отрезков равномерного разбиения кривой Безье по формуле Ванга.
+ * @param factor d(d-1)/8 для кривой степени d.
+ * @param maxSecondDiff Максимальная длина второй разности контрольных точек.
+ * @param tolerance Допустимое отклонение.
+ */
+int wangSegments(double factor, double maxSecondDiff, double tolerance) {
+    if (maxSecondDiff == 0) return 1;
+    if (tolerance <= 0) return MAX_CURVE_SEGMENTS;
+    double n = std::ceil(std::sqrt(factor * maxSecondDiff / tolerance));
+    return static_cast<int>(std::clamp(n, 1.0, static_cast<double>(MAX_CURVE_SEGMENTS)));
+}
+
+} // namespace
+
+CurvedContour CurvedContour::fromPolygon(const Contour& polygon) {
+    CurvedContour contour(polygon.front());
+    for (std::size_t i = 1; i < polygon.size(); ++i)
+        contour.lineTo(polygon[i]);
+    return contour;
+}
+
+void CurvedContour::lineTo(Point_2 end) {
+    segments_.push_back({ SegmentKind::Line, end });
+    invalidate();
+}
+
+void CurvedContour::arcTo(Point_2 end, double bulge) {
+    if (bulge == 0) {
+        lineTo(end);
+        return;
+    }
+    CurveSegment segment{ SegmentKind::Arc, end };
+    segment.bulge = bulge;
+    segments_.push_back(segment);
+    invalidate();
+}
+
+void CurvedContour::quadTo(Point_2 control, Point_2 end) {
+    segments_.push_back({ SegmentKind::QuadBezier, end, control });
+    invalidate();
+}
+
+void CurvedContour::cubicTo(Point_2 control1, Point_2 control2, Point_2 end) {
+    segments_.push_back({ SegmentKind::CubicBezier, end, control1, control2 });
+    invalidate();
+}
+
+const Contour& CurvedContour::flatten(double tolerance) const {
+    if (cachedTolerance_ == tolerance)
+        return cache_;
+
+    cache_.clear();
+    cache_.reserve(segments_.size() + 1);
+
+    Point_2 current = start_;
+    for (const auto& segment : segments_) {
+        cache_.push_back(current);
+        switch (segment.kind) {
+        case SegmentKind::Line:
+            break;
+        case SegmentKind::Arc:
+            appendBulgeArc(cache_, current, segment.end, segment.bulge, tolerance);
+            break;
+        case SegmentKind::QuadBezier:
+            appendQuadBezier(cache_, current, segment.control1, segment.end, tolerance);
+            break;
+        case SegmentKind::CubicBezier:
+            appendCubicBezier(cache_, current, segment.control1, segment.control2, segment.end, tolerance);
+            break;
+        }
+        current = segment.end;
+    }
+
+    // Замыкающая вершина совпадает с началом - в ломаной она не нужна.
+    if (current.x != start_.x || current.y != start_.y)
+        cache_.push_back(current);
+
+    cachedTolerance_ = tolerance;
+    return cache_;
+}
+
+Contours flattenContours(const CurvedContours& contours, double tolerance, std::pmr::memory_resource* resource) {
+    Contours result(resource);
+    result.reserve(contours.size());
+    for (const auto& contour : contours) {
+        const Contour& flat = contour.flatten(tolerance);
+        if (flat.size() >= 3) result.push_back(flat);
+    }
+    return result;
+}
+
+void appendBulgeArc(Contour& contour, const Point_2& from, const Point_2& to, double bulge, double tolerance) {
+    double dx = to.x - from.x;
+    double dy = to.y - from.y;
+    double chord = std::sqrt(dx * dx + dy * dy);
+    if (chord == 0 || bulge == 0) return;
+
+    // Центральный угол и радиус дуги.
+    double sweep = 4 * std::atan(bulge);
+    double radius = chord * (1 + bulge * bulge) / (4 * std::abs(bulge));
+
+    // Центр лежит на перпендикуляре к хорде, слева для дуги против часовой стрелки.
+    double d = chord * (1 - bulge * bulge) / (4 * bulge);
+    Point_2 center{
+        (from.x + to.x) / 2 - dy / chord * d,
+        (from.y + to.y) / 2 + dx / chord * d
+    };
+
+    // Число сегментов, при котором стрелка прогиба не превышает tolerance.
+    int segments = 1;
+    if (tolerance > 0 && tolerance < radius) {
+        double maxStep = 2 * std::acos(1 - tolerance / radius);
+        segments = static_cast<int>(std::ceil(std::abs(sweep) / maxStep));
+        segments = std::min(segments, MAX_CURVE_SEGMENTS);
+    }
+    else if (tolerance <= 0) {
+        segments = MAX_CURVE_SEGMENTS;
+    }
+
+    double startAngle = std::atan2(from.y - center.y, from.x - center.x);
+    for (int i = 1; i < segments; ++i) {
+        double a = startAngle + sweep * i / segments;
+        contour.push_back({ center.x + radius * std::cos(a), center.y + radius * std::sin(a) });
+    }
+}
+
+void appendQuadBezier(Contour& contour, const Point_2& p0, const Point_2& p1, const Point_2& p2, double tolerance) {
+    double dd = length(p0.x - 2 * p1.x + p2.x, p0.y - 2 * p1.y + p2.y);
+    int segments = wangSegments(2.0 / 8.0, dd, tolerance);
+
+    for (int i = 1; i < segments; ++i) {
+        double t = static_cast<double>(i) / segments;
+        double u = 1 - t;
+        contour.push_back({
+            u * u * p0.x + 2 * u * t * p1.x + t * t * p2.x,
+            u * u * p0.y + 2 * u * t * p1.y + t * t * p2.y });
+    }
+}
+
+void appendCubicBezier(Contour& contour, const Point_2& p0, const Point_2& p1, const Point_2& p2, const Point_2& p3,
+    double tolerance) {
+    double dd = std::max(
+        length(p0.x - 2 * p1.x + p2.x, p0.y - 2 * p1.y + p2.y),
+        length(p1.x - 2 * p2.x + p3.x, p1.y - 2 * p2.y + p3.y));
+    int segments = wangSegments(6.0 / 8.0, dd, tolerance);
+
+    for (int i = 1; i < segments; ++i) {
+        double t = static_cast<double>(i) / segments;
+        double u = 1 - t;
+        double b0 = u * u * u;
+        double b1 = 3 * u * u * t;
+        double b2 = 3 * u * t * t;
+        double b3 = t * t * t;
+        contour.push_back({
+            b0 * p0.x + b1 * p1.x + b2 * p2.x + b3 * p3.x,
+            b0 * p0.y + b1 * p1.y + b2 * p2.y + b3 * p3.y });
+    }
+}
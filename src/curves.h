@@ -0,0 +1,159 @@
+﻿/**
+ * @file curves.h
+ * @brief Контуры с криволинейными сегментами и их аппроксимация ломаной.
+ *
+ * Контур задаётся начальной точкой и последовательностью сегментов:
+ * отрезков, дуг (через bulge, как в DXF) и кривых Безье второй и третьей степени.
+ * Ломаная строится адаптивно под заданную точность и кэшируется в самом контуре,
+ * поэтому повторные проходы (другой угол, другой слой) её не пересчитывают.
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <vector>
+
+/// Доля шага штриховки, используемая как точность аппроксимации кривых.
+constexpr double FLATTENING_STEP_FRACTION = 0.1;
+
+/**
+ * @brief Точность аппроксимации кривых, согласованная с шагом штриховки.
+ *
+ * Отклонение хорды от кривой меньше доли шага не влияет на штриховку,
+ * а более грубая аппроксимация экономит вершины.
+ *
+ * @param step Шаг штриховки (`--step`).
+ * @return Допустимое отклонение ломаной от кривой.
+ */
+inline double flatteningToleranceForStep(double step) { return step * FLATTENING_STEP_FRACTION; }
+
+/**
+ * @brief Тип сегмента контура.
+ */
+enum class SegmentKind { Line, Arc, QuadBezier, CubicBezier };
+
+/**
+ * @brief Сегмент контура от конца предыдущего сегмента до точки end.
+ */
+struct CurveSegment {
+    /// Тип сегмента.
+    SegmentKind kind;
+    /// Конечная точка сегмента.
+    Point_2 end;
+    /// Первая контрольная точка (Безье).
+    Point_2 control1{};
+    /// Вторая контрольная точка (кубическая Безье).
+    Point_2 control2{};
+    /// Тангенс четверти центрального угла (дуга); знак задаёт направление.
+    double bulge = 0;
+};
+
+/**
+ * @brief Замкнутый контур из отрезков, дуг и кривых Безье.
+ *
+ * Последний сегмент неявно замыкается на начальную точку отрезком.
+ * Кэш ломаной не потокобезопасен: один контур не следует аппроксимировать
+ * одновременно из нескольких потоков.
+ */
+class CurvedContour {
+public:
+    /**
+     * @brief Создаёт контур с начальной точкой.
+     * @param start Начальная точка.
+     */
+    explicit CurvedContour(Point_2 start) : start_(start) {}
+
+    /**
+     * @brief Создаёт контур из готовой ломаной.
+     * @param polygon Вершины ломаной (не пустая).
+     * @return Контур из отрезков.
+     */
+    static CurvedContour fromPolygon(const Contour& polygon);
+
+    /// Добавляет отрезок до точки end.
+    void lineTo(Point_2 end);
+    /// Добавляет дугу до точки end, заданную bulge.
+    void arcTo(Point_2 end, double bulge);
+    /// Добавляет квадратичную кривую Безье.
+    void quadTo(Point_2 control, Point_2 end);
+    /// Добавляет кубическую кривую Безье.
+    void cubicTo(Point_2 control1, Point_2 control2, Point_2 end);
+
+    /// Начальная точка контура.
+    const Point_2& start() const { return start_; }
+    /// Сегменты контура.
+    const std::vector<CurveSegment>& segments() const { return segments_; }
+
+    /**
+     * @brief Возвращает ломаную, отклоняющуюся от контура не больше чем на tolerance.
+     *
+     * Результат кэшируется; повторный вызов с той же точностью возвращает кэш.
+     *
+     * @param tolerance Допустимое отклонение.
+     * @return Ссылка на кэшированную ломаную (действительна до изменения контура).
+     */
+    const Contour& flatten(double tolerance) const;
+
+private:
+    void invalidate() { cachedTolerance_ = -1; }
+
+    Point_2 start_;
+    std::vector<CurveSegment> segments_;
+
+    mutable Contour cache_;
+    mutable double cachedTolerance_ = -1;
+};
+
+/// Коллекция криволинейных контуров.
+using CurvedContours = std::vector<CurvedContour>;
+
+/**
+ * @brief Аппроксимирует все контуры ломаными (через кэш каждого контура).
+ *
+ * Контуры, у которых после аппроксимации меньше трёх вершин (окружность
+ * из двух дуг при точности не меньше радиуса), пропускаются.
+ *
+ * @param contours Криволинейные контуры.
+ * @param tolerance Допустимое отклонение.
+ * @param resource Источник памяти для результата.
+ * @return Ломаные контуры.
+ */
+Contours flattenContours(const CurvedContours& contours, double tolerance,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+/**
+ * @brief Добавляет в контур точки дуги, заданной параметром bulge.
+ *
+ * Начальная точка дуги в контур не добавляется (она уже там),
+ * конечная - тоже (её добавит следующая вершина).
+ *
+ * @param contour Контур, к которому дописываются точки.
+ * @param from Начальная точка дуги.
+ * @param to Конечная точка дуги.
+ * @param bulge Тангенс четверти центрального угла; знак задаёт направление (+ против часовой).
+ * @param tolerance Максимальное отклонение хорды от дуги.
+ */
+void appendBulgeArc(Contour& contour, const Point_2& from, const Point_2& to, double bulge, double tolerance);
+
+/**
+ * @brief Добавляет в контур внутренние точки квадратичной кривой Безье.
+ * @param contour Контур, к которому дописываются точки.
+ * @param p0 Начальная точка.
+ * @param p1 Контрольная точка.
+ * @param p2 Конечная точка (не добавляется).
+ * @param tolerance Максимальное отклонение.
+ */
+void appendQuadBezier(Contour& contour, const Point_2& p0, const Point_2& p1, const Point_2& p2, double tolerance);
+
+/**
+ * @brief Добавляет в контур внутренние точки кубической кривой Безье.
+ * @param contour Контур, к которому дописываются точки.
+ * @param p0 Начальная точка.
+ * @param p1 Первая контрольная точка.
+ * @param p2 Вторая контрольная точка.
+ * @param p3 Конечная точка (не добавляется).
+ * @param tolerance Максимальное отклонение.
+ */
+void appendCubicBezier(Contour& contour, const Point_2& p0, const Point_2& p1, const Point_2& p2, const Point_2& p3,
+    double tolerance);
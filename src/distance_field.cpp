@@ -0,0 +1,132 @@
+﻿/**
+ * @file distance_field.cpp
+ * @brief Реализация поля расстояний.
+ */
+
+#include "distance_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/// Верхний предел числа ячеек сетки.
+constexpr double MAX_CELLS = 4.0 * 1024 * 1024;
+
+double segmentDistance(const Point_2& p, const Line_2& edge) {
+    double ex = edge.end.x - edge.start.x, ey = edge.end.y - edge.start.y;
+    double px = p.x - edge.start.x, py = p.y - edge.start.y;
+    double lengthSquared = ex * ex + ey * ey;
+    double t = lengthSquared > 0 ? std::clamp((px * ex + py * ey) / lengthSquared, 0.0, 1.0) : 0;
+    return std::hypot(px - ex * t, py - ey * t);
+}
+
+} // namespace
+
+DistanceField::DistanceField(const Contours& contours, double cellSize, std::pmr::memory_resource* resource)
+    : edges_(resource), distance_(resource), nearest_(resource) {
+    for (const auto& contour : contours) {
+        for (std::size_t i = 0; i < contour.size(); ++i)
+            edges_.push_back({ contour[i], contour[(i + 1) % contour.size()] });
+    }
+
+    Point_2 high{};
+    if (!computeBounds(contours, origin_, high)) return;
+
+    double width = high.x - origin_.x;
+    double height = high.y - origin_.y;
+    cellSize_ = std::max(cellSize, std::sqrt(width * height / MAX_CELLS));
+    if (!(cellSize_ > 0)) cellSize_ = 1;
+    // Сетка с полем в одну ячейку вокруг рамки.
+    origin_ = { origin_.x - cellSize_, origin_.y - cellSize_ };
+    columns_ = static_cast<std::size_t>(width / cellSize_) + 3;
+    rows_ = static_cast<std::size_t>(height / cellSize_) + 3;
+
+    distance_.assign(columns_ * rows_, std::numeric_limits<double>::infinity());
+    nearest_.assign(columns_ * rows_, -1);
+
+    // Затравка: ячейки вдоль рёбер и их соседи.
+    for (std::size_t e = 0; e < edges_.size(); ++e) {
+        const Line_2& edge = edges_[e];
+        double length = std::hypot(edge.end.x - edge.start.x, edge.end.y - edge.start.y);
+        auto samples = static_cast<std::size_t>(std::ceil(2 * length / cellSize_)) + 1;
+        for (std::size_t s = 0; s <= samples; ++s) {
+            double t = static_cast<double>(s) / static_cast<double>(samples);
+            double x = edge.start.x + (edge.end.x - edge.start.x) * t;
+            double y = edge.start.y + (edge.end.y - edge.start.y) * t;
+            auto column = static_cast<long>((x - origin_.x) / cellSize_);
+            auto row = static_cast<long>((y - origin_.y) / cellSize_);
+            for (long r = std::max(row - 1, 0L); r <= std::min(row + 1, static_cast<long>(rows_) - 1); ++r) {
+                for (long c = std::max(column - 1, 0L); c <= std::min(column + 1, static_cast<long>(columns_) - 1); ++c) {
+                    std::size_t cell = static_cast<std::size_t>(r) * columns_ + static_cast<std::size_t>(c);
+                    double d = edgeDistance(static_cast<std::int32_t>(e), static_cast<std::size_t>(c),
+                        static_cast<std::size_t>(r));
+                    if (d < distance_[cell]) {
+                        distance_[cell] = d;
+                        nearest_[cell] = static_cast<std::int32_t>(e);
+                    }
+                }
+            }
+        }
+    }
+
+    // Распространение ближайшего ребра: вперёд от уже пройденных соседей, затем назад.
+    for (std::size_t r = 0; r < rows_; ++r) {
+        for (std::size_t c = 0; c < columns_; ++c) {
+            relax(c, r, -1, 0);
+            relax(c, r, -1, -1);
+            relax(c, r, 0, -1);
+            relax(c, r, 1, -1);
+        }
+        for (std::size_t c = columns_; c-- > 0;) relax(c, r, 1, 0);
+    }
+    for (std::size_t r = rows_; r-- > 0;) {
+        for (std::size_t c = columns_; c-- > 0;) {
+            relax(c, r, 1, 0);
+            relax(c, r, 1, 1);
+            relax(c, r, 0, 1);
+            relax(c, r, -1, 1);
+        }
+        for (std::size_t c = 0; c < columns_; ++c) relax(c, r, -1, 0);
+    }
+}
+
+double DistanceField::edgeDistance(std::int32_t edge, std::size_t column, std::size_t row) const {
+    Point_2 center{ origin_.x + (static_cast<double>(column) + 0.5) * cellSize_,
+                    origin_.y + (static_cast<double>(row) + 0.5) * cellSize_ };
+    return segmentDistance(center, edges_[static_cast<std::size_t>(edge)]);
+}
+
+void DistanceField::relax(std::size_t column, std::size_t row, long dc, long dr) {
+    long c = static_cast<long>(column) + dc;
+    long r = static_cast<long>(row) + dr;
+    if (c < 0 || r < 0 || c >= static_cast<long>(columns_) || r >= static_cast<long>(rows_)) return;
+
+    std::int32_t edge = nearest_[static_cast<std::size_t>(r) * columns_ + static_cast<std::size_t>(c)];
+    std::size_t cell = row * columns_ + column;
+    if (edge < 0 || edge == nearest_[cell]) return;
+    double d = edgeDistance(edge, column, row);
+    if (d < distance_[cell]) {
+        distance_[cell] = d;
+        nearest_[cell] = edge;
+    }
+}
+
+double DistanceField::at(const Point_2& p) const {
+    if (distance_.empty()) return std::numeric_limits<double>::infinity();
+
+    // Координаты относительно центров ячеек.
+    double x = std::clamp((p.x - origin_.x) / cellSize_ - 0.5, 0.0, static_cast<double>(columns_ - 1));
+    double y = std::clamp((p.y - origin_.y) / cellSize_ - 0.5, 0.0, static_cast<double>(rows_ - 1));
+    auto c0 = std::min(static_cast<std::size_t>(x), columns_ - 1);
+    auto r0 = std::min(static_cast<std::size_t>(y), rows_ - 1);
+    std::size_t c1 = std::min(c0 + 1, columns_ - 1);
+    std::size_t r1 = std::min(r0 + 1, rows_ - 1);
+    double fx = x - static_cast<double>(c0);
+    double fy = y - static_cast<double>(r0);
+
+    double bottom = distance_[r0 * columns_ + c0] * (1 - fx) + distance_[r0 * columns_ + c1] * fx;
+    double top = distance_[r1 * columns_ + c0] * (1 - fx) + distance_[r1 * columns_ + c1] * fx;
+    return bottom * (1 - fy) + top * fy;
+}
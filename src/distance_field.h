@@ -0,0 +1,61 @@
+﻿/**
+ * @file distance_field.h
+ * @brief Поле расстояний до контуров на равномерной сетке.
+ *
+ * Расстояние от точки до ближайшего ребра контуров нужно в каждой точке
+ * выборки вдоль всех линий штриховки; перебор рёбер на каждую точку
+ * слишком дорог. Поле считается один раз на сетке ячеек:
+ *
+ * 1. Ячейки вдоль рёбер (и их соседи) получают точное расстояние от центра
+ *    до ребра и номер этого ребра.
+ * 2. Два растровых прохода (вперёд и назад) переносят номер ближайшего ребра
+ *    от соседей: ячейка пробует рёбра соседей и берёт точное расстояние до
+ *    лучшего. Ошибка - только в редких вырожденных конфигурациях и не больше
+ *    размера ячейки.
+ *
+ * Запрос в произвольной точке - билинейная интерполяция по центрам ячеек.
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <cstdint>
+#include <memory_resource>
+
+/**
+ * @brief Поле беззнаковых расстояний до рёбер контуров.
+ */
+class DistanceField {
+public:
+    /**
+     * @brief Строит поле.
+     * @param contours Контуры.
+     * @param cellSize Желаемый размер ячейки (увеличивается, если сетка слишком велика).
+     * @param resource Источник памяти для сетки.
+     */
+    DistanceField(const Contours& contours, double cellSize,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /// Расстояние от точки до ближайшего ребра (за пределами сетки - по ближайшей ячейке).
+    double at(const Point_2& p) const;
+
+    /// Фактический размер ячейки.
+    double cellSize() const { return cellSize_; }
+    std::size_t columns() const { return columns_; }
+    std::size_t rows() const { return rows_; }
+
+private:
+    double edgeDistance(std::int32_t edge, std::size_t column, std::size_t row) const;
+    void relax(std::size_t column, std::size_t row, long dc, long dr);
+
+    Point_2 origin_{};
+    double cellSize_ = 1;
+    std::size_t columns_ = 0;
+    std::size_t rows_ = 0;
+    std::pmr::vector<Line_2> edges_;
+    /// Расстояние от центра ячейки до ближайшего известного ребра.
+    std::pmr::vector<double> distance_;
+    /// Номер этого ребра; -1 - ещё не найдено.
+    std::pmr::vector<std::int32_t> nearest_;
+};
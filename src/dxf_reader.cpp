@@ -0,0 +1,282 @@
+﻿/**
+ * @file dxf_reader.cpp
+ * @brief Реализация потокового чтения DXF.
+ */
+
+#include "dxf_reader.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+/**
+ * @brief Вершина полилинии вместе с bulge сегмента, который из неё выходит.
+ */
+struct DxfVertex {
+    double x = 0;
+    double y = 0;
+    double bulge = 0;
+};
+
+/**
+ * @brief Тип сущности, разбираемой в данный момент.
+ */
+enum class Entity { None, LwPolyline, Polyline, Vertex, Other };
+
+/// Флаг замкнутости полилинии (код группы 70).
+constexpr int CLOSED_FLAG = 1;
+/// Флаги POLYLINE, обозначающие сетки (3D mesh / polyface) - такие сущности пропускаются.
+constexpr int MESH_FLAGS = 16 | 64;
+/// Флаги VERTEX, обозначающие служебные вершины (контрольные точки сплайна, грани).
+constexpr int SERVICE_VERTEX_FLAGS = 16 | 128;
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+double parseDouble(std::string_view s, std::size_t lineNo) {
+    double value = 0;
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (ec != std::errc())
+        throw std::runtime_error("DXF: invalid number at line " + std::to_string(lineNo));
+    return value;
+}
+
+int parseInt(std::string_view s, std::size_t lineNo) {
+    int value = 0;
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (ec != std::errc())
+        throw std::runtime_error("DXF: invalid integer at line " + std::to_string(lineNo));
+    return value;
+}
+
+/**
+ * @brief Состояние разбора: текущая полилиния и текущая вершина.
+ *
+ * Буфер вершин переиспользуется между полилиниями, поэтому память
+ * ограничена размером самой большой полилинии файла.
+ */
+class DxfParser {
+public:
+    DxfParser(const CurvedContourSink& sink, DxfReadStats& stats)
+        : sink_(sink), stats_(stats) {}
+
+    /// Обрабатывает начало новой сущности (код группы 0).
+    void beginEntity(std::string_view name) {
+        endEntity();
+
+        if (name == "LWPOLYLINE") {
+            startPolyline(Entity::LwPolyline);
+        }
+        else if (name == "POLYLINE") {
+            startPolyline(Entity::Polyline);
+        }
+        else if (name == "VERTEX" && inPolyline_) {
+            current_ = Entity::Vertex;
+            vertex_ = {};
+            vertexFlags_ = 0;
+        }
+        else if (name == "SEQEND" && inPolyline_) {
+            flushPolyline();
+            current_ = Entity::Other;
+        }
+        else {
+            // Любая другая сущность завершает незакрытую последовательность POLYLINE.
+            if (inPolyline_) flushPolyline();
+            current_ = Entity::Other;
+        }
+    }
+
+    /// Обрабатывает пару "код - значение" внутри текущей сущности.
+    void group(int code, std::string_view value, std::size_t lineNo) {
+        switch (current_) {
+        case Entity::LwPolyline:
+            if (code == 70) flags_ = parseInt(value, lineNo);
+            else if (code == 10) vertices_.push_back({ parseDouble(value, lineNo), 0, 0 });
+            else if (code == 20 && !vertices_.empty()) vertices_.back().y = parseDouble(value, lineNo);
+            else if (code == 42 && !vertices_.empty()) vertices_.back().bulge = parseDouble(value, lineNo);
+            break;
+        case Entity::Polyline:
+            if (code == 70) flags_ = parseInt(value, lineNo);
+            break;
+        case Entity::Vertex:
+            if (code == 10) vertex_.x = parseDouble(value, lineNo);
+            else if (code == 20) vertex_.y = parseDouble(value, lineNo);
+            else if (code == 42) vertex_.bulge = parseDouble(value, lineNo);
+            else if (code == 70) vertexFlags_ = parseInt(value, lineNo);
+            break;
+        default:
+            break;
+        }
+    }
+
+    /// Завершает текущую сущность (конец секции или файла).
+    void endEntity() {
+        if (current_ == Entity::LwPolyline) {
+            flushPolyline();
+        }
+        else if (current_ == Entity::Vertex) {
+            if (!(vertexFlags_ & SERVICE_VERTEX_FLAGS))
+                vertices_.push_back(vertex_);
+        }
+        current_ = Entity::None;
+    }
+
+    /// Завершает всё незаконченное в конце секции.
+    void finish() {
+        endEntity();
+        if (inPolyline_) flushPolyline();
+    }
+
+private:
+    void startPolyline(Entity kind) {
+        if (inPolyline_) flushPolyline();
+        current_ = kind;
+        inPolyline_ = kind == Entity::Polyline;
+        flags_ = 0;
+        vertices_.clear();
+    }
+
+    void flushPolyline() {
+        inPolyline_ = false;
+        // Две вершины с дугами - так CAD записывает окружность; без дуг нужно не меньше трёх.
+        bool curved = std::any_of(vertices_.begin(), vertices_.end(), [](const DxfVertex& v) { return v.bulge != 0; });
+        if (flags_ & MESH_FLAGS || vertices_.size() < (curved ? 2u : 3u)) {
+            vertices_.clear();
+            return;
+        }
+
+        bool closed = (flags_ & CLOSED_FLAG) != 0;
+        const auto& first = vertices_.front();
+        const auto& last = vertices_.back();
+        if (first.x == last.x && first.y == last.y) {
+            vertices_.pop_back();
+            closed = true;
+        }
+
+        if (!closed || vertices_.size() < 2) {
+            ++stats_.skippedOpen;
+            vertices_.clear();
+            return;
+        }
+
+        CurvedContour contour({ first.x, first.y });
+        for (std::size_t i = 0; i < vertices_.size(); ++i) {
+            const auto& v = vertices_[i];
+            const auto& next = vertices_[(i + 1) % vertices_.size()];
+            contour.arcTo({ next.x, next.y }, v.bulge);
+        }
+        vertices_.clear();
+
+        ++stats_.contours;
+        sink_(std::move(contour));
+    }
+
+    const CurvedContourSink& sink_;
+    DxfReadStats& stats_;
+
+    Entity current_ = Entity::None;
+    bool inPolyline_ = false;
+    int flags_ = 0;
+    std::vector<DxfVertex> vertices_;
+    DxfVertex vertex_;
+    int vertexFlags_ = 0;
+};
+
+} // namespace
+
+DxfReadStats readDxfCurvedContours(std::istream& in, const CurvedContourSink& sink) {
+    DxfReadStats stats;
+    DxfParser parser(sink, stats);
+
+    std::string codeLine;
+    std::string valueLine;
+    std::size_t lineNo = 0;
+
+    bool inEntities = false;
+    bool expectSectionName = false;
+
+    while (std::getline(in, codeLine)) {
+        ++lineNo;
+        if (lineNo == 1 && codeLine.rfind("AutoCAD Binary DXF", 0) == 0)
+            throw std::runtime_error("DXF: binary DXF is not supported");
+
+        if (!std::getline(in, valueLine))
+            throw std::runtime_error("DXF: missing value for group at line " + std::to_string(lineNo));
+        ++lineNo;
+        ++stats.groups;
+
+        std::string_view codeText = trim(codeLine);
+        if (codeText.empty() && in.eof()) break;
+        int code = parseInt(codeText, lineNo - 1);
+        std::string_view value = trim(valueLine);
+
+        if (expectSectionName) {
+            expectSectionName = false;
+            if (code == 2) inEntities = value == "ENTITIES";
+            continue;
+        }
+
+        if (code == 0) {
+            if (value == "SECTION") {
+                expectSectionName = true;
+                continue;
+            }
+            if (value == "ENDSEC") {
+                if (inEntities) parser.finish();
+                inEntities = false;
+                continue;
+            }
+            if (value == "EOF") break;
+            if (inEntities) parser.beginEntity(value);
+            continue;
+        }
+
+        if (inEntities) parser.group(code, value, lineNo);
+    }
+
+    if (inEntities) parser.finish();
+    return stats;
+}
+
+DxfReadStats readDxfContours(std::istream& in, double tolerance, const ContourSink& sink) {
+    std::size_t degenerate = 0;
+    DxfReadStats stats = readDxfCurvedContours(in, [&](CurvedContour&& contour) {
+        Contour flat = contour.flatten(tolerance);
+        // Грубая точность может свести окружность из двух дуг к отрезку.
+        if (flat.size() < 3) {
+            ++degenerate;
+            return;
+        }
+        sink(std::move(flat));
+    });
+    stats.contours -= degenerate;
+    stats.skippedDegenerate += degenerate;
+    return stats;
+}
+
+CurvedContours readDxfCurvedFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("DXF: cannot open file " + path);
+
+    CurvedContours contours;
+    readDxfCurvedContours(in, [&](CurvedContour&& contour) { contours.push_back(std::move(contour)); });
+    return contours;
+}
+
+Contours readDxfFile(const std::string& path, double tolerance, std::pmr::memory_resource* resource) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("DXF: cannot open file " + path);
+
+    Contours contours(resource);
+    readDxfContours(in, tolerance, [&](Contour&& contour) { contours.push_back(std::move(contour)); });
+    return contours;
+}
@@ -0,0 +1,83 @@
+﻿/**
+ * @file dxf_reader.h
+ * @brief Потоковое чтение замкнутых контуров из DXF.
+ *
+ * Из секции ENTITIES извлекаются замкнутые LWPOLYLINE и POLYLINE/VERTEX.
+ * Замкнутая полилиния из двух вершин с дугами (так CAD записывает
+ * окружность) тоже контур; без дуг нужно не меньше трёх вершин.
+ * Дуги, заданные через bulge, сохраняются как дуги CurvedContour либо сразу
+ * аппроксимируются отрезками с заданной точностью.
+ * Файл читается построчно: в памяти одновременно находится только текущая
+ * сущность, готовые контуры сразу отдаются потребителю.
+ */
+
+#pragma once
+
+#include "geometry.h"
+#include "curves.h"
+
+#include <functional>
+#include <istream>
+#include <string>
+
+/**
+ * @brief Потребитель готовых контуров. Получает контур во владение.
+ */
+using ContourSink = std::function<void(Contour&&)>;
+
+/**
+ * @brief Потребитель криволинейных контуров. Получает контур во владение.
+ */
+using CurvedContourSink = std::function<void(CurvedContour&&)>;
+
+/**
+ * @brief Статистика чтения DXF.
+ */
+struct DxfReadStats {
+    /// Количество прочитанных пар "код группы - значение".
+    std::size_t groups = 0;
+    /// Количество отданных замкнутых контуров.
+    std::size_t contours = 0;
+    /// Количество пропущенных незамкнутых полилиний.
+    std::size_t skippedOpen = 0;
+    /// Количество контуров, выродившихся после аппроксимации дуг (меньше трёх вершин).
+    std::size_t skippedDegenerate = 0;
+};
+
+/**
+ * @brief Читает замкнутые полилинии из DXF-потока, сохраняя дуги.
+ * @param in Входной поток (текстовый DXF).
+ * @param sink Потребитель контуров.
+ * @return Статистика чтения.
+ * @throws std::runtime_error при нарушении структуры файла.
+ */
+DxfReadStats readDxfCurvedContours(std::istream& in, const CurvedContourSink& sink);
+
+/**
+ * @brief Читает замкнутые полилинии из DXF-потока.
+ * @param in Входной поток (текстовый DXF).
+ * @param tolerance Точность аппроксимации дуг.
+ * @param sink Потребитель контуров.
+ * @return Статистика чтения.
+ * @throws std::runtime_error при нарушении структуры файла.
+ */
+DxfReadStats readDxfContours(std::istream& in, double tolerance, const ContourSink& sink);
+
+/**
+ * @brief Читает все замкнутые полилинии DXF-файла, сохраняя дуги.
+ * @param path Путь к файлу.
+ * @return Прочитанные контуры.
+ * @throws std::runtime_error если файл не открывается или повреждён.
+ */
+CurvedContours readDxfCurvedFile(const std::string& path);
+
+/**
+ * @brief Читает все замкнутые полилинии DXF-файла в коллекцию контуров.
+ * @param path Путь к файлу.
+ * @param tolerance Точность аппроксимации дуг.
+ * @param resource Источник памяти для контуров.
+ * @return Прочитанные контуры.
+ * @throws std::runtime_error если файл не открывается или повреждён.
+ */
+Contours readDxfFile(const std::string& path, double tolerance,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
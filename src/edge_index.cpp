@@ -0,0 +1,126 @@
+﻿/**
+ * @file edge_index.cpp
+ * @brief Реализация корзинного индекса рёбер.
+ */
+
+#include "edge_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/// Верхний предел числа корзин.
+constexpr std::size_t MAX_BUCKETS = 1 << 16;
+
+} // namespace
+
+EdgeIndex::EdgeIndex(const Contours& contours, double angleDegrees, std::size_t bucketCount,
+    std::pmr::memory_resource* resource)
+    : edges_(resource), bucketStart_(resource), bucketEdges_(resource) {
+    double angleRadians = degreesToRadians(angleDegrees);
+    dir_ = { std::cos(angleRadians), std::sin(angleRadians) };
+    perp_ = { -dir_.y, dir_.x };
+
+    bool first = true;
+    for (const auto& contour : contours) {
+        for (std::size_t i = 0; i < contour.size(); ++i) {
+            const Point_2& a = contour[i];
+            const Point_2& b = contour[(i + 1) % contour.size()];
+
+            double ua = dir_.x * a.x + dir_.y * a.y;
+            double va = perp_.x * a.x + perp_.y * a.y;
+            double ub = dir_.x * b.x + dir_.y * b.y;
+            double vb = perp_.x * b.x + perp_.y * b.y;
+
+            if (first) {
+                minV_ = maxV_ = va;
+                first = false;
+            }
+            minV_ = std::min(minV_, va);
+            maxV_ = std::max(maxV_, va);
+
+            if (va == vb) continue; // параллельно штриховке - пересечений не даёт
+
+            if (va > vb) {
+                std::swap(ua, ub);
+                std::swap(va, vb);
+            }
+            edges_.push_back({ ua, va, (ub - ua) / (vb - va), vb });
+        }
+    }
+
+    if (bucketCount == 0)
+        bucketCount = std::clamp<std::size_t>(edges_.size() / 2, 1, MAX_BUCKETS);
+    bucketWidth_ = maxV_ > minV_ ? (maxV_ - minV_) / static_cast<double>(bucketCount) : 1;
+
+    auto bucketOf = [&](double v) {
+        double b = std::floor((v - minV_) / bucketWidth_);
+        return static_cast<std::size_t>(std::clamp(b, 0.0, static_cast<double>(bucketCount - 1)));
+    };
+
+    // Подсчёт размеров корзин и раскладка (CSR), чтобы не держать вектор на корзину.
+    bucketStart_.assign(bucketCount + 1, 0);
+    for (const auto& e : edges_) {
+        for (std::size_t b = bucketOf(e.v0), last = bucketOf(e.v1); b <= last; ++b)
+            ++bucketStart_[b + 1];
+    }
+    for (std::size_t b = 0; b < bucketCount; ++b)
+        bucketStart_[b + 1] += bucketStart_[b];
+
+    bucketEdges_.resize(bucketStart_.back());
+    std::pmr::vector<std::uint32_t> fill(bucketStart_.begin(), bucketStart_.end() - 1, resource);
+    for (std::uint32_t i = 0; i < edges_.size(); ++i) {
+        const auto& e = edges_[i];
+        for (std::size_t b = bucketOf(e.v0), last = bucketOf(e.v1); b <= last; ++b)
+            bucketEdges_[fill[b]++] = i;
+    }
+}
+
+void EdgeIndex::intersect(double offset, std::pmr::vector<double>& crossings) const {
+    crossings.clear();
+    if (edges_.empty() || offset < minV_ || offset > maxV_) return;
+
+    std::size_t bucketCount = bucketStart_.size() - 1;
+    double b = std::floor((offset - minV_) / bucketWidth_);
+    std::size_t bucket = static_cast<std::size_t>(std::clamp(b, 0.0, static_cast<double>(bucketCount - 1)));
+
+    for (std::uint32_t k = bucketStart_[bucket]; k < bucketStart_[bucket + 1]; ++k) {
+        const IndexedEdge& e = edges_[bucketEdges_[k]];
+        if (offset >= e.v0 && offset < e.v1)
+            crossings.push_back(e.u0 + (offset - e.v0) * e.dudv);
+    }
+    std::sort(crossings.begin(), crossings.end());
+}
+
+void hatchRow(const EdgeIndex& index, double offset, std::pmr::vector<double>& crossings, Lines& lines) {
+    index.intersect(offset, crossings);
+
+    for (std::size_t i = 0; i + 1 < crossings.size(); i += 2) {
+        if (crossings[i] == crossings[i + 1]) continue;
+        lines.push_back({ index.toWorld(crossings[i], offset), index.toWorld(crossings[i + 1], offset) });
+    }
+}
+
+void hatchWithIndex(const EdgeIndex& index, double step, Lines& lines, std::pmr::memory_resource* resource) {
+    std::pmr::vector<double> crossings(resource);
+    // Концы отрезков в повёрнутой системе: начало и конец подряд.
+    PointArrays ends(resource);
+
+    double first = std::ceil(index.minOffset() / step);
+    double last = std::floor(index.maxOffset() / step);
+    for (double k = first; k <= last; ++k) {
+        double offset = k * step;
+        index.intersect(offset, crossings);
+        for (std::size_t i = 0; i + 1 < crossings.size(); i += 2) {
+            if (crossings[i] == crossings[i + 1]) continue;
+            ends.push_back(crossings[i], offset);
+            ends.push_back(crossings[i + 1], offset);
+        }
+    }
+
+    transformPoints(index.worldTransform(), ends);
+    lines.reserve(lines.size() + ends.size() / 2);
+    for (std::size_t i = 0; i + 1 < ends.size(); i += 2)
+        lines.push_back({ { ends.x[i], ends.y[i] }, { ends.x[i + 1], ends.y[i + 1] } });
+}
@@ -0,0 +1,126 @@
+﻿/**
+ * @file edge_index.h
+ * @brief Индекс рёбер контуров по оси смещения штриховки.
+ *
+ * Для направления штриховки dir = (cos a, sin a) каждая линия штриховки задаётся
+ * смещением s по перпендикуляру perp = (-sin a, cos a). Ребро контура пересекает
+ * линию, только если s лежит в проекции ребра на perp. Индекс раскладывает рёбра
+ * по корзинам вдоль perp, так что линия проверяет лишь рёбра своей корзины,
+ * а не все рёбра всех контуров.
+ */
+
+#pragma once
+
+#include "geometry.h"
+#include "transform_kernel.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @brief Ребро в повёрнутой системе координат (u - вдоль штриховки, v - смещение).
+ */
+struct IndexedEdge {
+    /// Координата u точки с меньшим v.
+    double u0;
+    /// Меньшее смещение ребра.
+    double v0;
+    /// Приращение u на единицу смещения.
+    double dudv;
+    /// Большее смещение ребра.
+    double v1;
+};
+
+/**
+ * @brief Корзинный индекс рёбер по смещению для одного угла.
+ *
+ * Строится один раз на контуры и угол и переиспользуется всеми линиями
+ * и проходами с этим углом.
+ */
+class EdgeIndex {
+public:
+    /**
+     * @brief Строит индекс.
+     * @param contours Замкнутые контуры.
+     * @param angleDegrees Угол штриховки в градусах.
+     * @param bucketCount Число корзин; 0 - подобрать по числу рёбер.
+     * @param resource Источник памяти для рёбер и корзин (например, арена задания).
+     */
+    EdgeIndex(const Contours& contours, double angleDegrees, std::size_t bucketCount = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /// Направление штриховки.
+    const Point_2& direction() const { return dir_; }
+    /// Направление смещения (перпендикуляр к штриховке).
+    const Point_2& normal() const { return perp_; }
+    /// Минимальное смещение, при котором линия касается контуров.
+    double minOffset() const { return minV_; }
+    /// Максимальное смещение, при котором линия касается контуров.
+    double maxOffset() const { return maxV_; }
+    /// Количество проиндексированных (не параллельных штриховке) рёбер.
+    std::size_t edgeCount() const { return edges_.size(); }
+
+    /**
+     * @brief Находит пересечения линии со смещением offset с контурами.
+     *
+     * Возвращает координаты u точек пересечения в порядке возрастания.
+     * Вершины учитываются по правилу полуинтервала [v0, v1), поэтому
+     * число пересечений всегда чётное.
+     *
+     * @param offset Смещение линии.
+     * @param crossings Буфер результата (очищается).
+     */
+    void intersect(double offset, std::pmr::vector<double>& crossings) const;
+
+    /**
+     * @brief Переводит точку из повёрнутой системы в мировую.
+     * @param u Координата вдоль штриховки.
+     * @param v Смещение.
+     * @return Точка в мировых координатах.
+     */
+    Point_2 toWorld(double u, double v) const {
+        return { dir_.x * u + perp_.x * v, dir_.y * u + perp_.y * v };
+    }
+
+    /// Преобразование из повёрнутой системы в мировую (то же, что toWorld) для массивов точек.
+    Transform2 worldTransform() const { return { dir_.x, perp_.x, dir_.y, perp_.y }; }
+
+private:
+    Point_2 dir_;
+    Point_2 perp_;
+    double minV_ = 0;
+    double maxV_ = 0;
+    double bucketWidth_ = 1;
+
+    std::pmr::vector<IndexedEdge> edges_;
+    /// Начала корзин в bucketEdges_ (размер - число корзин + 1).
+    std::pmr::vector<std::uint32_t> bucketStart_;
+    /// Индексы рёбер, сгруппированные по корзинам.
+    std::pmr::vector<std::uint32_t> bucketEdges_;
+};
+
+/**
+ * @brief Строит отрезки одной линии штриховки внутри контуров (правило чётности).
+ * @param index Индекс рёбер для нужного угла.
+ * @param offset Смещение линии.
+ * @param crossings Рабочий буфер пересечений.
+ * @param lines Выходные отрезки (дописываются).
+ */
+void hatchRow(const EdgeIndex& index, double offset, std::pmr::vector<double>& crossings, Lines& lines);
+
+/**
+ * @brief Штрихует область внутри контуров (правило чётности) с помощью индекса.
+ *
+ * Линии идут со смещениями, кратными step, поэтому результат не зависит
+ * от положения контуров относительно начала координат. Концы отрезков
+ * копятся в повёрнутой системе и переводятся в мировую одним векторным
+ * проходом (transformPoints).
+ *
+ * @param index Индекс рёбер для нужного угла.
+ * @param step Шаг штриховки.
+ * @param lines Выходные отрезки (дописываются).
+ * @param resource Источник памяти для рабочих буферов.
+ */
+void hatchWithIndex(const EdgeIndex& index, double step, Lines& lines,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
@@ -0,0 +1,133 @@
+﻿/**
+ * @file fill_pattern.cpp
+ * @brief Реализация узоров заполнения.
+ */
+
+#include "fill_pattern.h"
+
+#include "curves.h"
+#include "hatcher.h"
+#include "lattice_pattern.h"
+#include "offset.h"
+#include "perimeter.h"
+#include "polygon_clip.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/// Наибольший шаг угла спирали: и у самого центра дуга не вырождается в ломаную из трёх звеньев.
+constexpr double MAX_SPIRAL_ANGLE_STEP = std::numbers::pi / 8;
+
+/// Переход между вложенными петлями длиннее stitch * step начинает новую ломаную.
+constexpr double CONCENTRIC_STITCH = 2.0;
+
+double distanceSquared(const Point_2& a, const Point_2& b) {
+    double dx = a.x - b.x, dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+class LinesPattern final : public FillPattern {
+public:
+    explicit LinesPattern(double angleDegrees) : angleDegrees_(angleDegrees) {}
+
+    const char* name() const override { return "lines"; }
+
+    void fill(const Contours& region, double step, Polylines& out) const override {
+        std::pmr::memory_resource* resource = out.get_allocator().resource();
+        Lines lines(resource);
+        hatchContours(region, angleDegrees_, step, lines, resource);
+        out.reserve(out.size() + lines.size());
+        for (const auto& line : lines) {
+            out.emplace_back();
+            out.back().assign({ line.start, line.end });
+        }
+    }
+
+private:
+    double angleDegrees_;
+};
+
+class ConcentricPattern final : public FillPattern {
+public:
+    const char* name() const override { return "concentric"; }
+
+    void fill(const Contours& region, double step, Polylines& out) const override {
+        std::pmr::memory_resource* resource = out.get_allocator().resource();
+        Point_2 position{ 0, 0 };
+        // Сцеплять можно только с ломаной, выданной этим вызовом.
+        std::size_t first = out.size();
+        double stitch = CONCENTRIC_STITCH * step;
+
+        Contours level = offsetContours(region, -step / 2, {}, nullptr, resource);
+        while (!level.empty()) {
+            Polylines loops(resource);
+            for (const auto& contour : level) {
+                loops.emplace_back(contour.begin(), contour.end());
+                loops.back().push_back(contour.front());
+            }
+            orderLoops(loops, position);
+
+            for (auto& loop : loops) {
+                if (out.size() > first && distanceSquared(out.back().back(), loop.front()) <= stitch * stitch)
+                    out.back().insert(out.back().end(), loop.begin(), loop.end());
+                else
+                    out.push_back(std::move(loop));
+            }
+            level = offsetContours(level, -step, {}, nullptr, resource);
+        }
+    }
+};
+
+class SpiralPattern final : public FillPattern {
+public:
+    explicit SpiralPattern(double angleDegrees) : phase_(degreesToRadians(angleDegrees)) {}
+
+    const char* name() const override { return "spiral"; }
+
+    void fill(const Contours& region, double step, Polylines& out) const override {
+        Point_2 low{};
+        Point_2 high{};
+        if (!computeBounds(region, low, high)) return;
+
+        std::pmr::memory_resource* resource = out.get_allocator().resource();
+        Point_2 center{ (low.x + high.x) / 2, (low.y + high.y) / 2 };
+        double radius = std::hypot(high.x - low.x, high.y - low.y) / 2;
+        double perTurn = step / (2 * std::numbers::pi);
+        double tolerance = flatteningToleranceForStep(step);
+
+        // Шаг угла из допустимого прогиба хорды: r * dphi^2 / 8 <= tolerance.
+        Polyline spiral(resource);
+        double phi = 0;
+        double last = radius / perTurn;
+        while (true) {
+            double r = perTurn * phi;
+            spiral.push_back({ center.x + r * std::cos(phi + phase_), center.y + r * std::sin(phi + phase_) });
+            if (phi >= last) break;
+            double dphi = r > 0 ? std::sqrt(8 * tolerance / r) : MAX_SPIRAL_ANGLE_STEP;
+            phi = std::min(phi + std::min(dphi, MAX_SPIRAL_ANGLE_STEP), last);
+        }
+
+        PolygonClipper clipper(region, resource);
+        clipper.clipPolyline(spiral, out);
+    }
+
+private:
+    double phase_;
+};
+
+} // namespace
+
+std::unique_ptr<FillPattern> makeFillPattern(std::string_view name, double angleDegrees, double density) {
+    if (name == "lines") return std::make_unique<LinesPattern>(angleDegrees);
+    if (name == "concentric") return std::make_unique<ConcentricPattern>();
+    if (name == "spiral") return std::make_unique<SpiralPattern>(angleDegrees);
+    if (name == "grid") return makeLatticePattern(LatticeKind::Grid, angleDegrees, density);
+    if (name == "triangles") return makeLatticePattern(LatticeKind::Triangles, angleDegrees, density);
+    if (name == "hexagons") return makeLatticePattern(LatticeKind::Hexagons, angleDegrees, density);
+    if (name == "gyroid") return makeLatticePattern(LatticeKind::Gyroid, angleDegrees, density);
+    throw std::invalid_argument("Unknown fill pattern: " + std::string(name));
+}
@@ -0,0 +1,57 @@
+﻿/**
+ * @file fill_pattern.h
+ * @brief Узоры заполнения области: параллельные линии, концентрический, спираль.
+ *
+ * Узор получает область (контуры по правилу чётности) и шаг и выдаёт
+ * траектории ломаными в порядке прохода. Для материалов, где важна
+ * непрерывность прохода, узоры стараются выдавать длинные ломаные, чтобы
+ * инструмент реже останавливался и включался:
+ *
+ * - lines - обычная штриховка под углом, каждая линия - отдельная ломаная;
+ * - concentric - эквидистанты контура с шагом step внутрь (как периметры);
+ *   соседние по вложенности петли сцепляются в одну ломаную коротким переходом;
+ * - spiral - архимедова спираль r = step * phi / 2pi из центра рамки области,
+ *   обрезанная по контурам (PolygonClipper::clipPolyline): внутри области
+ *   спираль идёт одним куском до выхода за границу;
+ * - grid, triangles, hexagons, gyroid - решётки заданной плотности
+ *   (lattice_pattern.h).
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <memory>
+#include <string_view>
+
+/**
+ * @brief Узор заполнения.
+ *
+ * fill можно вызывать одновременно из нескольких потоков (пакетная обработка).
+ */
+class FillPattern {
+public:
+    virtual ~FillPattern() = default;
+
+    /// Имя узора (как в `--pattern`).
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Заполняет область.
+     * @param region Контуры области (правило чётности).
+     * @param step Расстояние между соседними проходами.
+     * @param out Траектории в порядке прохода (дописываются; их источник памяти
+     *            используется и для временных структур).
+     */
+    virtual void fill(const Contours& region, double step, Polylines& out) const = 0;
+};
+
+/**
+ * @brief Создаёт узор по имени.
+ * @param name Имя: lines, concentric, spiral, grid, triangles, hexagons или gyroid.
+ * @param angleDegrees Угол линий (поворот решётки); для спирали - начальная фаза.
+ * @param density Доля площади под дорожками для решёток.
+ * @return Узор.
+ * @throws std::invalid_argument при неизвестном имени или недопустимой плотности.
+ */
+std::unique_ptr<FillPattern> makeFillPattern(std::string_view name, double angleDegrees, double density);
@@ -0,0 +1,94 @@
+﻿/**
+ * @file geometry.h
+ * @brief Базовые геометрические типы hatch_generator.
+ *
+ * Точки, линии и контуры, которыми обмениваются чтение входных данных,
+ * генерация штриховки и запись результата.
+ */
+
+#pragma once
+
+#include <memory_resource>
+#include <numbers>
+#include <vector>
+
+ /**
+  * @brief Точка в 2D пространстве.
+  */
+struct Point_2 {
+    /**
+     * @brief Координата X.
+     */
+    double x;
+
+    /**
+     * @brief Координата Y.
+     */
+    double y;
+};
+
+/**
+ * @brief Линия, представленная двумя точками (начало и конец).
+ */
+struct Line_2 {
+    /**
+     * @brief Начальная точка линии.
+     */
+    Point_2 start;
+
+    /**
+     * @brief Конечная точка линии.
+     */
+    Point_2 end;
+};
+
+/*
+ * Геометрические контейнеры - std::pmr-векторы: источник памяти задаёт тот,
+ * кто создаёт контейнер (арена задания, пул, huge pages), а вложенные контуры
+ * наследуют его от коллекции. По умолчанию используется обычная куча.
+ */
+
+/// Контур - список точек.
+using Contour = std::pmr::vector<Point_2>;
+/// Коллекция контуров.
+using Contours = std::pmr::vector<Contour>;
+/// Коллекция линий.
+using Lines = std::pmr::vector<Line_2>;
+/// Ломаная траектории: точки в порядке прохода (у замкнутой последняя совпадает с первой).
+using Polyline = std::pmr::vector<Point_2>;
+/// Коллекция ломаных.
+using Polylines = std::pmr::vector<Polyline>;
+
+/**
+ * @brief Конвертирует угол из градусов в радианы.
+ * @param degrees Угол в градусах.
+ * @return Угол в радианах.
+ */
+inline double degreesToRadians(double degrees) { return degrees * std::numbers::pi / 180.0; }
+
+/**
+ * @brief Вычисляет ограничивающий прямоугольник набора контуров.
+ * @param contours Контуры.
+ * @param bottomLeft Нижняя левая точка прямоугольника (выход).
+ * @param topRight Верхняя правая точка прямоугольника (выход).
+ * @return false, если в контурах нет ни одной точки.
+ */
+inline bool computeBounds(const Contours& contours, Point_2& bottomLeft, Point_2& topRight) {
+    bool found = false;
+    for (const auto& contour : contours) {
+        for (const auto& p : contour) {
+            if (!found) {
+                bottomLeft = p;
+                topRight = p;
+                found = true;
+                continue;
+            }
+            if (p.x < bottomLeft.x) bottomLeft.x = p.x;
+            else if (p.x > topRight.x) topRight.x = p.x;
+
+            if (p.y < bottomLeft.y) bottomLeft.y = p.y;
+            else if (p.y > topRight.y) topRight.y = p.y;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,111 @@
+﻿/**
+ * @file hatch_session.cpp
+ * @brief Реализация инкрементальной перештриховки.
+ */
+
+#include "hatch_session.h"
+
+#include <cmath>
+
+namespace {
+
+/// Сколько индексов рёбер (для разных углов) держать в сессии.
+constexpr std::size_t MAX_CACHED_INDICES = 8;
+
+/// Относительная погрешность, при которой смещения считаются совпадающими.
+constexpr double OFFSET_EPSILON = 1e-9;
+
+} // namespace
+
+HatchSession::HatchSession(CurvedContours contours, double tolerance, std::pmr::memory_resource* resource)
+    : resource_(resource), curved_(std::move(contours)), flat_(resource), fixedTolerance_(tolerance),
+      rows_(resource), lines_(resource) {}
+
+const Contours& HatchSession::prepare(double step) {
+    double wanted = fixedTolerance_ > 0 ? fixedTolerance_ : flatteningToleranceForStep(step);
+
+    // Перестраиваем только если текущая аппроксимация заметно грубее нужной:
+    // иначе каждое движение ползунка шага сбрасывало бы все кэши.
+    if (tolerance_ > 0 && tolerance_ <= wanted * 2) return flat_;
+
+    tolerance_ = wanted;
+    flat_ = flattenContours(curved_, tolerance_, resource_);
+    indices_.clear();
+    rows_.clear();
+    lines_.clear();
+    stats_.geometryRebuilt = true;
+    return flat_;
+}
+
+const EdgeIndex& HatchSession::indexFor(double angleDegrees) {
+    for (auto it = indices_.begin(); it != indices_.end(); ++it) {
+        if (it->angle == angleDegrees) {
+            indices_.splice(indices_.begin(), indices_, it);
+            return indices_.front().index;
+        }
+    }
+
+    if (indices_.size() >= MAX_CACHED_INDICES) indices_.pop_back();
+    indices_.push_front({ angleDegrees, EdgeIndex(flat_, angleDegrees, 0, resource_) });
+    stats_.indexBuilt = true;
+    return indices_.front().index;
+}
+
+const Lines& HatchSession::update(double angleDegrees, double step) {
+    auto startTime = std::chrono::steady_clock::now();
+    stats_ = {};
+
+    prepare(step);
+    const EdgeIndex& index = indexFor(angleDegrees);
+
+    bool canReuse = !rows_.empty() && angleDegrees == angle_;
+    std::pmr::vector<Row> oldRows(resource_);
+    Lines oldLines(resource_);
+    oldRows.swap(rows_);
+    oldLines.swap(lines_);
+    double oldStep = step_;
+
+    std::int64_t first = static_cast<std::int64_t>(std::ceil(index.minOffset() / step));
+    std::int64_t last = static_cast<std::int64_t>(std::floor(index.maxOffset() / step));
+    std::int64_t oldFirst = oldRows.empty() ? 0 : oldRows.front().k;
+
+    rows_.reserve(last >= first ? static_cast<std::size_t>(last - first + 1) : 0);
+    lines_.reserve(oldLines.size());
+    std::pmr::vector<double> crossings(resource_);
+
+    for (std::int64_t k = first; k <= last; ++k) {
+        double offset = static_cast<double>(k) * step;
+        Row row{ k, static_cast<std::uint32_t>(lines_.size()), 0 };
+
+        bool reused = false;
+        if (canReuse) {
+            // Номер прежней линии с тем же смещением, если такая была.
+            double j = std::round(offset / oldStep);
+            if (std::abs(j * oldStep - offset) <= OFFSET_EPSILON * std::max(std::abs(offset), step)) {
+                std::int64_t pos = static_cast<std::int64_t>(j) - oldFirst;
+                if (pos >= 0 && pos < static_cast<std::int64_t>(oldRows.size())) {
+                    const Row& old = oldRows[static_cast<std::size_t>(pos)];
+                    lines_.insert(lines_.end(), oldLines.begin() + old.first, oldLines.begin() + old.first + old.count);
+                    reused = true;
+                }
+            }
+        }
+
+        if (reused) {
+            ++stats_.reusedRows;
+        }
+        else {
+            hatchRow(index, offset, crossings, lines_);
+            ++stats_.computedRows;
+        }
+
+        row.count = static_cast<std::uint32_t>(lines_.size() - row.first);
+        rows_.push_back(row);
+    }
+
+    angle_ = angleDegrees;
+    step_ = step;
+    stats_.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime);
+    return lines_;
+}
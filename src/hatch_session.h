@@ -0,0 +1,106 @@
+﻿/**
+ * @file hatch_session.h
+ * @brief Сессия инкрементальной перештриховки для интерактивного просмотра.
+ *
+ * Сессия держит подготовленную геометрию (аппроксимированные контуры и индексы
+ * рёбер для недавних углов) и линии предыдущего запроса. При новом запросе
+ * пересчитывается только изменившееся: если угол прежний, линии со смещениями,
+ * совпадающими с прежними, берутся из предыдущего результата. Например, при
+ * уменьшении шага вдвое переиспользуется каждая вторая линия, а при увеличении
+ * вдвое не пересчитывается ни одна.
+ */
+
+#pragma once
+
+#include "geometry.h"
+#include "curves.h"
+#include "edge_index.h"
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <vector>
+
+/**
+ * @brief Статистика последнего обновления сессии.
+ */
+struct HatchUpdateStats {
+    /// Полное время обновления.
+    std::chrono::microseconds latency{ 0 };
+    /// Количество линий штриховки (смещений), взятых из предыдущего результата.
+    std::size_t reusedRows = 0;
+    /// Количество линий штриховки, посчитанных заново.
+    std::size_t computedRows = 0;
+    /// Была ли заново аппроксимирована геометрия.
+    bool geometryRebuilt = false;
+    /// Был ли построен новый индекс рёбер.
+    bool indexBuilt = false;
+};
+
+/**
+ * @brief Долгоживущая сессия штриховки одного набора контуров.
+ */
+class HatchSession {
+public:
+    /**
+     * @brief Создаёт сессию.
+     * @param contours Исходные контуры (копируются в сессию).
+     * @param tolerance Точность аппроксимации; 0 - по шагу первого запроса.
+     * @param resource Источник памяти для геометрии и линий сессии.
+     */
+    explicit HatchSession(CurvedContours contours, double tolerance = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Подготавливает геометрию под шаг (аппроксимирует кривые при необходимости).
+     * @param step Шаг штриховки.
+     * @return Аппроксимированные контуры.
+     */
+    const Contours& prepare(double step);
+
+    /**
+     * @brief Возвращает штриховку для угла и шага, пересчитывая только изменившееся.
+     * @param angleDegrees Угол штриховки в градусах.
+     * @param step Шаг штриховки.
+     * @return Линии штриховки (действительны до следующего вызова).
+     */
+    const Lines& update(double angleDegrees, double step);
+
+    /// Статистика последнего вызова update().
+    const HatchUpdateStats& lastUpdate() const { return stats_; }
+
+    /// Аппроксимированные контуры, по которым строится штриховка.
+    const Contours& contours() const { return flat_; }
+
+private:
+    /// Линия штриховки с номером смещения k (смещение = k * step).
+    struct Row {
+        std::int64_t k;
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+
+    /// Индекс рёбер, построенный для конкретного угла.
+    struct CachedIndex {
+        double angle;
+        EdgeIndex index;
+    };
+
+    const EdgeIndex& indexFor(double angleDegrees);
+
+    std::pmr::memory_resource* resource_;
+    CurvedContours curved_;
+    Contours flat_;
+    double fixedTolerance_;
+    double tolerance_ = -1;
+
+    /// Недавние индексы, самый свежий - первый.
+    std::list<CachedIndex> indices_;
+
+    double angle_ = 0;
+    double step_ = 0;
+    std::pmr::vector<Row> rows_;
+    Lines lines_;
+
+    HatchUpdateStats stats_;
+};
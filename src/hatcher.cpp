@@ -0,0 +1,283 @@
+﻿/**
+ * @file hatcher.cpp
+ * @brief Реализация генерации штриховки.
+ */
+
+#include "hatcher.h"
+#include "edge_index.h"
+#include "robust_predicates.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+int computeOutCode(double x, double y, const Point_2& bottomLeft, const Point_2& topRight) {
+    int code = INSIDE;
+    if (x < bottomLeft.x) code |= LEFT;
+    else if (x > topRight.x) code |= RIGHT;
+
+    if (y < bottomLeft.y) code |= BOTTOM;
+    else if (y > topRight.y) code |= TOP;
+
+    return code;
+}
+
+bool clipLine(Line_2& line, const Point_2& bottomLeft, const Point_2& topRight) {
+    double x0 = line.start.x, y0 = line.start.y;
+    double x1 = line.end.x, y1 = line.end.y;
+
+    int outcode0 = computeOutCode(x0, y0, bottomLeft, topRight);
+    int outcode1 = computeOutCode(x1, y1, bottomLeft, topRight);
+    bool accept = false;
+
+    // Оба конца снаружи с разных сторон: задевает ли прямая прямоугольник, решает
+    // точный знак ориентации углов, а не пересечения, посчитанные делением.
+    if (outcode0 && outcode1 && !(outcode0 & outcode1)) {
+        // Крайние по нормали к отрезку углы - концы диагонали, поперечной его направлению.
+        bool rising = (x1 - x0) * (y1 - y0) > 0;
+        Point_2 first = rising ? Point_2{ bottomLeft.x, topRight.y } : bottomLeft;
+        Point_2 second = rising ? Point_2{ topRight.x, bottomLeft.y } : topRight;
+        double o1 = orient2d(line.start, line.end, first);
+        double o2 = orient2d(line.start, line.end, second);
+        if ((o1 > 0 && o2 > 0) || (o1 < 0 && o2 < 0)) return false;
+    }
+
+    // Точка пересечения лежит на отрезке: округление при почти параллельной
+    // стороне не должно уводить её за концы.
+    const double spanLowX = std::min(x0, x1), spanHighX = std::max(x0, x1);
+    const double spanLowY = std::min(y0, y1), spanHighY = std::max(y0, y1);
+
+    while (true) {
+        if (!(outcode0 | outcode1)) {   // Оба внутри
+            accept = true;
+            break;
+        }
+        else if (outcode0 & outcode1) { // Полностью вне
+            break;
+        }
+        else {
+            double x, y;
+            int outcodeOut = outcode0 ? outcode0 : outcode1;
+
+            if (outcodeOut & TOP) {
+                x = std::clamp(x0 + (x1 - x0) * (topRight.y - y0) / (y1 - y0), spanLowX, spanHighX);
+                y = topRight.y;
+            }
+            else if (outcodeOut & BOTTOM) {
+                x = std::clamp(x0 + (x1 - x0) * (bottomLeft.y - y0) / (y1 - y0), spanLowX, spanHighX);
+                y = bottomLeft.y;
+            }
+            else if (outcodeOut & RIGHT) {
+                y = std::clamp(y0 + (y1 - y0) * (topRight.x - x0) / (x1 - x0), spanLowY, spanHighY);
+                x = topRight.x;
+            }
+            else { // LEFT
+                y = std::clamp(y0 + (y1 - y0) * (bottomLeft.x - x0) / (x1 - x0), spanLowY, spanHighY);
+                x = bottomLeft.x;
+            }
+
+            if (outcodeOut == outcode0) {
+                x0 = x; y0 = y;
+                outcode0 = computeOutCode(x0, y0, bottomLeft, topRight);
+            }
+            else {
+                x1 = x; y1 = y;
+                outcode1 = computeOutCode(x1, y1, bottomLeft, topRight);
+            }
+        }
+    }
+
+    if (accept) {
+        line.start = { x0, y0 };
+        line.end = { x1, y1 };
+        return true;
+    }
+    return false;
+}
+
+bool isAxisAlignedRectangle(const Contours& contours) {
+    if (contours.size() != 1 || contours[0].size() != 4) return false;
+
+    const Contour& c = contours[0];
+    for (size_t i = 0; i < c.size(); ++i) {
+        const Point_2& p1 = c[i];
+        const Point_2& p2 = c[(i + 1) % c.size()];
+        if (p1.x != p2.x && p1.y != p2.y) return false;
+    }
+    return true;
+}
+
+namespace {
+
+/// Сдвиг первой строки и число строк: смещения -diagonal / 2 + n * step, задевающие прямоугольник.
+struct RowRange {
+    double first;
+    double last;
+};
+
+RowRange rowRange(double width, double height, double diagonal, const Point_2& dir, double step) {
+    // Прямая со смещением v пересекает прямоугольник, только если |v| не больше
+    // половины проекции прямоугольника на перпендикуляр: остальные строки не строятся.
+    double reach = (width * std::abs(dir.y) + height * std::abs(dir.x)) / 2;
+    return { std::max(std::ceil((diagonal / 2 - reach) / step), 0.0), std::floor((diagonal / 2 + reach) / step) };
+}
+
+/**
+ * @brief Штриховка прямоугольника под углом, известным при компиляции.
+ *
+ * Специализации для 0, 45, 90 и 135 градусов обходятся сложениями: строка
+ * отличается от предыдущей постоянным сдвигом, а концы лежат на сторонах
+ * или на диагонали x +- y = const без тригонометрии и деления.
+ */
+template <int AngleDegrees>
+struct RectangleKernel;
+
+template <>
+struct RectangleKernel<0> {
+    static void run(const Point_2& bottomLeft, const Point_2& topRight, double, double step, Lines& lines) {
+        for (double y = bottomLeft.y; y <= topRight.y; y += step) {
+            lines.push_back({ {bottomLeft.x, y}, {topRight.x, y} });
+        }
+    }
+};
+
+template <>
+struct RectangleKernel<90> {
+    static void run(const Point_2& bottomLeft, const Point_2& topRight, double, double step, Lines& lines) {
+        for (double x = bottomLeft.x; x <= topRight.x; x += step) {
+            lines.push_back({ {x, bottomLeft.y}, {x, topRight.y} });
+        }
+    }
+};
+
+template <>
+struct RectangleKernel<45> {
+    static void run(const Point_2& bottomLeft, const Point_2& topRight, double, double step, Lines& lines) {
+        double width = topRight.x - bottomLeft.x;
+        double height = topRight.y - bottomLeft.y;
+        double diagonal = std::sqrt(width * width + height * height);
+        RowRange rows = rowRange(width, height, diagonal, { std::numbers::sqrt2 / 2, std::numbers::sqrt2 / 2 }, step);
+
+        // Строка - прямая y = x + d; d растёт на step * sqrt(2) от строки к строке.
+        double d = (bottomLeft.y + topRight.y) / 2 - (bottomLeft.x + topRight.x) / 2
+            + std::numbers::sqrt2 * (rows.first * step - diagonal / 2);
+        double delta = std::numbers::sqrt2 * step;
+        for (double n = rows.first; n <= rows.last; ++n, d += delta) {
+            Point_2 start = bottomLeft.x + d >= bottomLeft.y ? Point_2{ bottomLeft.x, bottomLeft.x + d }
+                                                             : Point_2{ bottomLeft.y - d, bottomLeft.y };
+            Point_2 end = topRight.x + d <= topRight.y ? Point_2{ topRight.x, topRight.x + d }
+                                                       : Point_2{ topRight.y - d, topRight.y };
+            if (start.x > end.x) continue;
+            lines.push_back({ start, end });
+        }
+    }
+};
+
+template <>
+struct RectangleKernel<135> {
+    static void run(const Point_2& bottomLeft, const Point_2& topRight, double, double step, Lines& lines) {
+        double width = topRight.x - bottomLeft.x;
+        double height = topRight.y - bottomLeft.y;
+        double diagonal = std::sqrt(width * width + height * height);
+        RowRange rows = rowRange(width, height, diagonal, { -std::numbers::sqrt2 / 2, std::numbers::sqrt2 / 2 }, step);
+
+        // Строка - прямая x + y = e; e убывает на step * sqrt(2), проход - справа снизу влево вверх.
+        double e = (bottomLeft.x + topRight.x) / 2 + (bottomLeft.y + topRight.y) / 2
+            - std::numbers::sqrt2 * (rows.first * step - diagonal / 2);
+        double delta = std::numbers::sqrt2 * step;
+        for (double n = rows.first; n <= rows.last; ++n, e -= delta) {
+            Point_2 start = e - topRight.x >= bottomLeft.y ? Point_2{ topRight.x, e - topRight.x }
+                                                           : Point_2{ e - bottomLeft.y, bottomLeft.y };
+            Point_2 end = e - bottomLeft.x <= topRight.y ? Point_2{ bottomLeft.x, e - bottomLeft.x }
+                                                         : Point_2{ e - topRight.y, topRight.y };
+            if (start.x < end.x) continue;
+            lines.push_back({ start, end });
+        }
+    }
+};
+
+/// Общий случай: угол известен только во время выполнения.
+void hatchRectangleAnyAngle(const Point_2& bottomLeft, const Point_2& topRight, double angleDegrees, double step,
+    Lines& lines) {
+    double angleRadians = degreesToRadians(angleDegrees);
+
+    double width = topRight.x - bottomLeft.x;
+    double height = topRight.y - bottomLeft.y;
+    double diagonal = std::sqrt(width * width + height * height);
+
+    Point_2 center{
+        (bottomLeft.x + topRight.x) / 2,
+        (bottomLeft.y + topRight.y) / 2
+    };
+
+    Point_2 dir{ std::cos(angleRadians), std::sin(angleRadians) };
+    Point_2 perp{ -dir.y, dir.x };
+    RowRange rows = rowRange(width, height, diagonal, dir, step);
+
+    // Пересечение прямой base + dir * u с прямоугольником - пересечение двух слоёв
+    // по x и по y. Знаки dir постоянны для всех строк, поэтому ближняя и дальняя
+    // стороны каждого слоя выбираются один раз, а строка сравнивает два входа и два выхода.
+    double inverseX = 1 / dir.x;
+    double inverseY = 1 / dir.y;
+    double enterX = dir.x > 0 ? bottomLeft.x : topRight.x;
+    double leaveX = dir.x > 0 ? topRight.x : bottomLeft.x;
+    double enterY = dir.y > 0 ? bottomLeft.y : topRight.y;
+    double leaveY = dir.y > 0 ? topRight.y : bottomLeft.y;
+
+    lines.reserve(lines.size() + static_cast<std::size_t>(std::max(rows.last - rows.first + 1, 0.0)));
+    for (double n = rows.first; n <= rows.last; ++n) {
+        double offset = -diagonal / 2 + n * step;
+        Point_2 base{ center.x + perp.x * offset, center.y + perp.y * offset };
+
+        double enterAtX = (enterX - base.x) * inverseX;
+        double enterAtY = (enterY - base.y) * inverseY;
+        double leaveAtX = (leaveX - base.x) * inverseX;
+        double leaveAtY = (leaveY - base.y) * inverseY;
+        if (std::max(enterAtX, enterAtY) > std::min(leaveAtX, leaveAtY)) continue;
+
+        // Координата на стороне входа/выхода берётся точно, а не из base + dir * u.
+        Point_2 start = enterAtX >= enterAtY ? Point_2{ enterX, base.y + dir.y * enterAtX }
+                                             : Point_2{ base.x + dir.x * enterAtY, enterY };
+        Point_2 end = leaveAtX <= leaveAtY ? Point_2{ leaveX, base.y + dir.y * leaveAtX }
+                                           : Point_2{ base.x + dir.x * leaveAtY, leaveY };
+        lines.push_back({ start, end });
+    }
+}
+
+} // namespace
+
+double normalizeHatchAngle(double angleDegrees, double tolerance) {
+    double angle = std::fmod(angleDegrees, 180.0);
+    if (angle < 0) angle += 180;
+    for (double special : { 0.0, 45.0, 90.0, 135.0, 180.0 }) {
+        if (std::abs(angle - special) <= tolerance) return special == 180 ? 0 : special;
+    }
+    return angle;
+}
+
+RectangleHatcher selectRectangleHatcher(double angleDegrees) {
+    angleDegrees = normalizeHatchAngle(angleDegrees);
+    if (angleDegrees == 0) return &RectangleKernel<0>::run;
+    if (angleDegrees == 45) return &RectangleKernel<45>::run;
+    if (angleDegrees == 90) return &RectangleKernel<90>::run;
+    if (angleDegrees == 135) return &RectangleKernel<135>::run;
+    return &hatchRectangleAnyAngle;
+}
+
+void hatchRectangle(const Point_2& bottomLeft, const Point_2& topRight, double angleDegrees, double step, Lines& lines) {
+    selectRectangleHatcher(angleDegrees)(bottomLeft, topRight, angleDegrees, step, lines);
+}
+
+void hatchContours(const Contours& contours, double angleDegrees, double step, Lines& lines,
+    std::pmr::memory_resource* scratch) {
+    if (isAxisAlignedRectangle(contours)) {
+        Point_2 bottomLeft{};
+        Point_2 topRight{};
+        computeBounds(contours, bottomLeft, topRight);
+        hatchRectangle(bottomLeft, topRight, angleDegrees, step, lines);
+        return;
+    }
+
+    EdgeIndex index(contours, angleDegrees, 0, scratch);
+    hatchWithIndex(index, step, lines, scratch);
+}
@@ -0,0 +1,132 @@
+﻿/**
+ * @file hatcher.h
+ * @brief Генерация штриховки: обрезка по прямоугольнику и выбор алгоритма.
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <memory_resource>
+
+/**
+ * @enum OutCode
+ * @brief Коды положения точки относительно прямоугольника
+ * (используются в алгоритме Коэна–Сазерленда).
+ *
+ * INSIDE – внутри
+ * LEFT / RIGHT – вне по X
+ * BOTTOM / TOP – вне по Y
+ */
+enum OutCode { INSIDE = 0, LEFT = 1, RIGHT = 2, BOTTOM = 4, TOP = 8 };
+
+/**
+ * @brief Вычисляет OutCode для точки относительно прямоугольника.
+ * @param x Координата X точки.
+ * @param y Координата Y точки.
+ * @param bottomLeft Нижняя левая точка прямоугольника.
+ * @param topRight Верхняя правая точка прямоугольника.
+ * @return Код положения.
+ */
+int computeOutCode(double x, double y, const Point_2& bottomLeft, const Point_2& topRight);
+
+/**
+ * @brief Обрезает линию в пределах прямоугольника по алгоритму Коэна–Сазерленда.
+ *
+ * Если оба конца снаружи, задевает ли отрезок прямоугольник, решает точный
+ * предикат ориентации (orient2d) по его углам. Сами точки пересечения
+ * по-прежнему считаются делением в обычной арифметике и лишь
+ * ограничиваются диапазоном координат отрезка: они не выходят за его концы,
+ * но точными не являются.
+ *
+ * @param line Линия для обрезки. На выходе содержит усечённую версию.
+ * @param bottomLeft Нижняя левая точка ограничивающего прямоугольника.
+ * @param topRight Верхняя правая точка прямоугольника.
+ * @return true, если линия пересекает прямоугольник и была обрезана;
+ *         false, если линия полностью вне прямоугольника.
+ */
+bool clipLine(Line_2& line, const Point_2& bottomLeft, const Point_2& topRight);
+
+/**
+ * @brief Проверяет, что контуры - один прямоугольник со сторонами вдоль осей.
+ *
+ * Такой контур штрихуется hatchRectangle, без индекса рёбер.
+ *
+ * @param contours Контуры.
+ * @return true, если это единственный осевой прямоугольник.
+ */
+bool isAxisAlignedRectangle(const Contours& contours);
+
+/// Допуск сравнения угла штриховки с особыми углами, градусы.
+constexpr double ANGLE_TOLERANCE = 1e-9;
+
+/**
+ * @brief Приводит угол штриховки к [0, 180).
+ *
+ * Штриховка под углами a и a + 180 состоит из одних и тех же прямых, поэтому
+ * 180, 270, -90 и 360 градусов попадают на быстрые пути для 0 и 90. Углы в
+ * пределах допуска от 0, 45, 90 и 135 (и от 180) заменяются ими точно.
+ * Ядра осевых углов проходят строки в направлении приведённого угла.
+ *
+ * @param angleDegrees Угол в градусах.
+ * @param tolerance Допуск привязки к особым углам.
+ * @return Угол в [0, 180).
+ */
+double normalizeHatchAngle(double angleDegrees, double tolerance = ANGLE_TOLERANCE);
+
+/**
+ * @brief Штриховка осевого прямоугольника с заданным углом.
+ *
+ * Параметры как у hatchRectangle; специализированные варианты угол не читают.
+ */
+using RectangleHatcher = void (*)(const Point_2& bottomLeft, const Point_2& topRight, double angleDegrees,
+    double step, Lines& lines);
+
+/**
+ * @brief Выбирает штриховку прямоугольника для угла (один раз на задание).
+ *
+ * Для 0, 45, 90 и 135 градусов (после normalizeHatchAngle) возвращаются
+ * специализации шаблона с углом как параметром: строки строятся одними
+ * сложениями. Остальные углы идут через общий вариант с пересечением слоёв
+ * и исходным углом, так что их строки не сдвигаются.
+ *
+ * @param angleDegrees Угол штриховки в градусах.
+ * @return Функция штриховки.
+ */
+RectangleHatcher selectRectangleHatcher(double angleDegrees);
+
+/**
+ * @brief Штрихует осевой прямоугольник без обрезки.
+ *
+ * Вариант выбирается selectRectangleHatcher по углу, приведённому
+ * normalizeHatchAngle. Для 0, 45, 90 и 135 градусов работают ядра
+ * RectangleKernel: строки идут от края прямоугольника, концы лежат на его
+ * сторонах (или на диагонали x +- y = const) и получаются сложениями. Для
+ * остальных углов диапазон смещений, при которых прямая задевает
+ * прямоугольник, считается аналитически, а концы строки - пересечение
+ * прямой со слоями по x и по y (две пары max/min). Ни один вариант не
+ * строит отрезок длиной в диагональ и не вызывает clipLine.
+ *
+ * @param bottomLeft Нижняя левая точка прямоугольника.
+ * @param topRight Верхняя правая точка прямоугольника.
+ * @param angleDegrees Угол штриховки в градусах.
+ * @param step Шаг штриховки.
+ * @param lines Выходные линии (дописываются).
+ */
+void hatchRectangle(const Point_2& bottomLeft, const Point_2& topRight, double angleDegrees, double step, Lines& lines);
+
+/**
+ * @brief Штрихует произвольные контуры, выбирая подходящий алгоритм.
+ *
+ * Осевой прямоугольник штрихуется hatchRectangle (ядро для угла или
+ * пересечение со слоями), остальные контуры - через индекс рёбер по
+ * правилу чётности.
+ *
+ * @param contours Контуры.
+ * @param angleDegrees Угол штриховки в градусах.
+ * @param step Шаг штриховки.
+ * @param lines Выходные линии (дописываются).
+ * @param scratch Источник памяти для временных структур (индекс рёбер, буферы).
+ */
+void hatchContours(const Contours& contours, double angleDegrees, double step, Lines& lines,
+    std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
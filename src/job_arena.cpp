@@ -0,0 +1,53 @@
+﻿/**
+ * @file job_arena.cpp
+ * @brief Реализация арены заданий.
+ */
+
+#include "job_arena.h"
+
+#include <algorithm>
+
+namespace {
+
+/// Запас к пиковому объёму при росте буфера (учёт выравнивания и служебных блоков).
+constexpr double GROWTH_MARGIN = 1.25;
+
+} // namespace
+
+JobArena::JobArena(std::size_t initialBytes, std::pmr::memory_resource* upstream)
+    : upstream_(upstream), bufferSize_(std::max<std::size_t>(initialBytes, 1024)) {
+    rebuild();
+}
+
+void JobArena::rebuild() {
+    buffer_ = std::make_unique<std::byte[]>(bufferSize_);
+    monotonic_.emplace(buffer_.get(), bufferSize_, upstream_);
+}
+
+void JobArena::reset() {
+    if (inUse_ > bufferSize_) {
+        ++overflows_;
+        bufferSize_ = static_cast<std::size_t>(static_cast<double>(inUse_) * GROWTH_MARGIN);
+        monotonic_.reset();
+        rebuild();
+    }
+    else {
+        monotonic_->release();
+    }
+    inUse_ = 0;
+}
+
+void* JobArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void* p = monotonic_->allocate(bytes, alignment);
+    inUse_ += bytes;
+    peak_ = std::max(peak_, inUse_);
+    return p;
+}
+
+void JobArena::do_deallocate(void*, std::size_t, std::size_t) {
+    // Монотонная арена освобождает память только целиком в reset().
+}
+
+bool JobArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
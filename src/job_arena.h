@@ -0,0 +1,71 @@
+﻿/**
+ * @file job_arena.h
+ * @brief Монотонная арена памяти на одно задание (совместима с std::pmr).
+ *
+ * Все выделения задания берутся из арены подряд и не освобождаются по одному;
+ * reset() между заданиями возвращает арену в начальное состояние одним действием.
+ * Начальный буфер арены растёт до пикового объёма уже выполненных заданий,
+ * поэтому в установившемся режиме задания вообще не обращаются к системному
+ * распределителю.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+/**
+ * @brief Арена заданий: std::pmr::memory_resource поверх monotonic_buffer_resource.
+ *
+ * Не потокобезопасна: одна арена обслуживает один поток (один рабочий поток
+ * конвейера или сервера).
+ */
+class JobArena : public std::pmr::memory_resource {
+public:
+    /**
+     * @brief Создаёт арену.
+     * @param initialBytes Начальный размер собственного буфера.
+     * @param upstream Источник памяти сверх буфера.
+     */
+    explicit JobArena(std::size_t initialBytes = 64 * 1024,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    JobArena(const JobArena&) = delete;
+    JobArena& operator=(const JobArena&) = delete;
+
+    /**
+     * @brief Освобождает всю память задания.
+     *
+     * Если задание вышло за пределы буфера, буфер увеличивается до его объёма.
+     * Все объекты, размещённые в арене, к этому моменту должны быть уничтожены.
+     */
+    void reset();
+
+    /// Байты, выделенные с последнего reset().
+    std::size_t bytesInUse() const { return inUse_; }
+    /// Наибольший объём одного задания за время жизни арены.
+    std::size_t peakBytes() const { return peak_; }
+    /// Текущий размер собственного буфера.
+    std::size_t bufferBytes() const { return bufferSize_; }
+    /// Сколько раз задания выходили за пределы буфера.
+    std::size_t overflows() const { return overflows_; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    void rebuild();
+
+    std::pmr::memory_resource* upstream_;
+    std::unique_ptr<std::byte[]> buffer_;
+    std::size_t bufferSize_;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic_;
+
+    std::size_t inUse_ = 0;
+    std::size_t peak_ = 0;
+    std::size_t overflows_ = 0;
+};
@@ -0,0 +1,222 @@
+﻿/**
+ * @file lattice_pattern.cpp
+ * @brief Реализация решётчатых узоров заполнения.
+ */
+
+#include "lattice_pattern.h"
+
+#include "polygon_clip.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+/// Точек на период волны гироида.
+constexpr int GYROID_SAMPLES = 32;
+
+/// Развёртка переиспользуется, пока её площадь не больше стольких площадей нужной.
+constexpr double EXPANSION_REUSE_RATIO = 4.0;
+
+void addPath(LatticeTile& tile, std::initializer_list<Point_2> points, int chainX, int chainY) {
+    LatticePath path;
+    path.points.assign(points);
+    path.chainX = chainX;
+    path.chainY = chainY;
+    tile.paths.push_back(std::move(path));
+}
+
+/// Плитка с единичным масштабом решётки.
+LatticeTile unitTile(LatticeKind kind) {
+    const double root3 = std::sqrt(3.0);
+    LatticeTile tile;
+    switch (kind) {
+    case LatticeKind::Grid:
+        addPath(tile, { { 0, 0 }, { 1, 0 } }, 1, 0);
+        addPath(tile, { { 0, 0 }, { 0, 1 } }, 0, 1);
+        break;
+    case LatticeKind::Triangles:
+        // Узлы (i + j / 2, j * sqrt(3) / 2); наклонные прямые проходят через плитку по диагонали.
+        tile.height = root3;
+        addPath(tile, { { 0, 0 }, { 1, 0 } }, 1, 0);
+        addPath(tile, { { 0, root3 / 2 }, { 1, root3 / 2 } }, 1, 0);
+        addPath(tile, { { 0, 0 }, { 1, root3 } }, 1, 1);
+        addPath(tile, { { 1, 0 }, { 0, root3 } }, -1, 1);
+        break;
+    case LatticeKind::Hexagons:
+        // Шестиугольники со стороной 1 и острой вершиной вверх; центры в (0, 0) и (sqrt(3) / 2, 1.5).
+        tile.width = root3;
+        tile.height = 3;
+        addPath(tile, { { 0, 1 }, { root3 / 2, 0.5 }, { root3, 1 } }, 1, 0);
+        addPath(tile, { { 0, 1 }, { 0, 2 } }, 0, 0);
+        addPath(tile, { { 0, 2 }, { root3 / 2, 2.5 }, { root3, 2 } }, 1, 0);
+        addPath(tile, { { root3 / 2, 2.5 }, { root3 / 2, 3.5 } }, 0, 0);
+        break;
+    case LatticeKind::Gyroid: {
+        tile.width = 2 * std::numbers::pi;
+        tile.height = std::numbers::pi;
+        LatticePath wave;
+        wave.chainX = 1;
+        for (int k = 0; k <= GYROID_SAMPLES; ++k) {
+            double x = tile.width * k / GYROID_SAMPLES;
+            wave.points.push_back({ x, -std::atan(std::sin(x)) });
+        }
+        tile.paths.push_back(std::move(wave));
+        break;
+    }
+    }
+    return tile;
+}
+
+void checkDensity(double density) {
+    if (!(density > 0 && density <= 1))
+        throw std::invalid_argument("Lattice density must be in (0, 1]");
+}
+
+/// Диапазон копий плитки по обеим осям.
+struct TileRange {
+    long i0 = 0, i1 = -1;
+    long j0 = 0, j1 = -1;
+
+    bool contains(long i, long j) const { return i >= i0 && i <= i1 && j >= j0 && j <= j1; }
+    bool covers(const TileRange& other) const {
+        return other.i0 >= i0 && other.i1 <= i1 && other.j0 >= j0 && other.j1 <= j1;
+    }
+    double area() const { return static_cast<double>(i1 - i0 + 1) * static_cast<double>(j1 - j0 + 1); }
+};
+
+class LatticePattern final : public FillPattern {
+public:
+    LatticePattern(LatticeKind kind, double angleDegrees, double density)
+        : kind_(kind), density_(density),
+          cos_(std::cos(degreesToRadians(angleDegrees))), sin_(std::sin(degreesToRadians(angleDegrees))) {
+        checkDensity(density);
+    }
+
+    const char* name() const override {
+        switch (kind_) {
+        case LatticeKind::Grid: return "grid";
+        case LatticeKind::Triangles: return "triangles";
+        case LatticeKind::Hexagons: return "hexagons";
+        case LatticeKind::Gyroid: return "gyroid";
+        }
+        return "lattice";
+    }
+
+    void fill(const Contours& region, double step, Polylines& out) const override {
+        Point_2 low{};
+        Point_2 high{};
+        if (!computeBounds(region, low, high)) return;
+
+        std::shared_ptr<const Polylines> lattice = expansionFor(low, high, step);
+        PolygonClipper clipper(region, out.get_allocator().resource());
+        for (const auto& path : *lattice)
+            clipper.clipPolyline(path, out);
+    }
+
+private:
+    /// Развёртка решётки, покрывающая рамку; строится заново, только если кэш не подходит.
+    std::shared_ptr<const Polylines> expansionFor(const Point_2& low, const Point_2& high, double step) const {
+        std::lock_guard lock(mutex_);
+        if (!tile_ || step != tileStep_) {
+            tile_ = std::make_unique<LatticeTile>(makeLatticeTile(kind_, step, density_));
+            tileStep_ = step;
+            expansion_.reset();
+        }
+
+        // Рамка в системе решётки (повёрнутой на угол узора).
+        double u0 = std::numeric_limits<double>::infinity(), u1 = -u0;
+        double v0 = u0, v1 = -u0;
+        for (const Point_2& p : { low, high, Point_2{ low.x, high.y }, Point_2{ high.x, low.y } }) {
+            double u = p.x * cos_ + p.y * sin_;
+            double v = -p.x * sin_ + p.y * cos_;
+            u0 = std::min(u0, u); u1 = std::max(u1, u);
+            v0 = std::min(v0, v); v1 = std::max(v1, v);
+        }
+        // Ломаные плитки выходят за её пределы не больше чем на одну плитку.
+        TileRange range;
+        range.i0 = static_cast<long>(std::floor(u0 / tile_->width)) - 1;
+        range.i1 = static_cast<long>(std::floor(u1 / tile_->width));
+        range.j0 = static_cast<long>(std::floor(v0 / tile_->height)) - 1;
+        range.j1 = static_cast<long>(std::floor(v1 / tile_->height));
+
+        if (expansion_ && expansionRange_.covers(range)
+            && expansionRange_.area() <= EXPANSION_REUSE_RATIO * range.area())
+            return expansion_;
+
+        expansion_ = std::make_shared<const Polylines>(expand(range));
+        expansionRange_ = range;
+        return expansion_;
+    }
+
+    Polylines expand(const TileRange& range) const {
+        Polylines result;
+        for (const auto& path : tile_->paths) {
+            bool chained = path.chainX != 0 || path.chainY != 0;
+            for (long j = range.j0; j <= range.j1; ++j) {
+                for (long i = range.i0; i <= range.i1; ++i) {
+                    // Сцепленная ломаная начинается с копии, у которой нет предшественника в диапазоне.
+                    if (chained && range.contains(i - path.chainX, j - path.chainY)) continue;
+
+                    Polyline polyline;
+                    long ci = i, cj = j;
+                    do {
+                        double dx = static_cast<double>(ci) * tile_->width;
+                        double dy = static_cast<double>(cj) * tile_->height;
+                        // Первая точка копии совпадает с последней точкой предыдущей.
+                        for (std::size_t k = polyline.empty() ? 0 : 1; k < path.points.size(); ++k) {
+                            double u = path.points[k].x + dx;
+                            double v = path.points[k].y + dy;
+                            polyline.push_back({ u * cos_ - v * sin_, u * sin_ + v * cos_ });
+                        }
+                        ci += path.chainX;
+                        cj += path.chainY;
+                    } while (chained && range.contains(ci, cj));
+                    result.push_back(std::move(polyline));
+                }
+            }
+        }
+        return result;
+    }
+
+    LatticeKind kind_;
+    double density_;
+    double cos_;
+    double sin_;
+
+    mutable std::mutex mutex_;
+    mutable std::unique_ptr<LatticeTile> tile_;
+    mutable double tileStep_ = 0;
+    mutable std::shared_ptr<const Polylines> expansion_;
+    mutable TileRange expansionRange_;
+};
+
+} // namespace
+
+LatticeTile makeLatticeTile(LatticeKind kind, double step, double density) {
+    checkDensity(density);
+    LatticeTile tile = unitTile(kind);
+
+    double length = 0;
+    for (const auto& path : tile.paths) {
+        for (std::size_t k = 1; k < path.points.size(); ++k)
+            length += std::hypot(path.points[k].x - path.points[k - 1].x, path.points[k].y - path.points[k - 1].y);
+    }
+    // Покрытие step * L * s / (W * H * s^2) = density.
+    double scale = step * length / (density * tile.width * tile.height);
+
+    tile.width *= scale;
+    tile.height *= scale;
+    for (auto& path : tile.paths) {
+        for (auto& p : path.points) p = { p.x * scale, p.y * scale };
+    }
+    return tile;
+}
+
+std::unique_ptr<FillPattern> makeLatticePattern(LatticeKind kind, double angleDegrees, double density) {
+    return std::make_unique<LatticePattern>(kind, angleDegrees, density);
+}
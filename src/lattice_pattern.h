@@ -0,0 +1,83 @@
+﻿/**
+ * @file lattice_pattern.h
+ * @brief Решётчатые узоры заполнения: сетка, треугольники, соты, гироид.
+ *
+ * Решётка задаётся плиткой - прямоугольником W x H с несколькими ломаными,
+ * которые при переносе плитки на (i * W, j * H) образуют бесконечный узор.
+ * Ломаная, конец которой совпадает с началом её копии в соседней плитке
+ * (прямые семейства сетки и треугольников, зигзаги сот, волны гироида),
+ * при развёртке сцепляется с копиями в одну длинную ломаную - инструмент
+ * проходит ряд решётки без остановок.
+ *
+ * Размер плитки подбирается по плотности: доля площади, покрытой дорожками
+ * шириной step, равна step * L / (W * H), где L - длина ломаных плитки.
+ *
+ * Необрезанная решётка зависит только от шага и охватываемой области, поэтому
+ * узор хранит плитку и последнюю развёртку: слои с той же или меньшей рамкой
+ * (пакет однотипных деталей, слои одной детали) платят только за обрезку по
+ * контуру через PolygonClipper::clipPolyline.
+ */
+
+#pragma once
+
+#include "fill_pattern.h"
+
+#include <vector>
+
+/// Доля площади под дорожками по умолчанию.
+constexpr double DEFAULT_LATTICE_DENSITY = 0.2;
+
+/**
+ * @brief Вид решётки.
+ */
+enum class LatticeKind {
+    /// Квадратная сетка: два семейства прямых под прямым углом.
+    Grid,
+    /// Треугольники: три семейства прямых через 60 градусов.
+    Triangles,
+    /// Соты: правильные шестиугольники (зигзаги рядов и вертикальные перемычки).
+    Hexagons,
+    /// Гироид: сечение z = 0 поверхности sin x cos y + sin y cos z + sin z cos x = 0,
+    /// то есть волны y = pi * k - atan(sin x).
+    Gyroid
+};
+
+/**
+ * @brief Ломаная плитки.
+ */
+struct LatticePath {
+    /// Точки в координатах плитки.
+    Polyline points;
+    /// Сдвиг в плитках, на котором ломаная продолжается своей копией; (0, 0) - не сцепляется.
+    int chainX = 0;
+    int chainY = 0;
+};
+
+/**
+ * @brief Плитка решётки.
+ */
+struct LatticeTile {
+    double width = 1;
+    double height = 1;
+    std::vector<LatticePath> paths;
+};
+
+/**
+ * @brief Строит плитку решётки заданной плотности.
+ * @param kind Вид решётки.
+ * @param step Ширина дорожки.
+ * @param density Доля площади под дорожками, (0, 1].
+ * @return Плитка.
+ * @throws std::invalid_argument при недопустимой плотности.
+ */
+LatticeTile makeLatticeTile(LatticeKind kind, double step, double density);
+
+/**
+ * @brief Создаёт решётчатый узор.
+ * @param kind Вид решётки.
+ * @param angleDegrees Поворот решётки в градусах.
+ * @param density Доля площади под дорожками, (0, 1].
+ * @return Узор (fill потокобезопасен: кэш плитки защищён мьютексом).
+ * @throws std::invalid_argument при недопустимой плотности.
+ */
+std::unique_ptr<FillPattern> makeLatticePattern(LatticeKind kind, double angleDegrees, double density);
@@ -0,0 +1,261 @@
+﻿/**
+ * @file line_postprocess.cpp
+ * @brief Реализация постобработки штриховки.
+ */
+
+#include "line_postprocess.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/// Наименьший квант угла, радианы: точнее double всё равно не различает направления.
+constexpr double MIN_ANGLE_QUANTUM = 1e-12;
+
+struct LineKey {
+    std::int64_t angle;
+    std::int64_t offset;
+
+    bool operator==(const LineKey&) const = default;
+};
+
+struct LineKeyHash {
+    std::size_t operator()(const LineKey& key) const {
+        auto h = static_cast<std::uint64_t>(key.angle) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h ^ (static_cast<std::uint64_t>(key.offset) + (h << 6) + (h >> 2)));
+    }
+};
+
+/// Отрезок группы в проекции на опорное направление группы.
+struct Interval {
+    std::size_t index;
+    double u0;
+    double u1;
+    Point_2 low;
+    Point_2 high;
+    /// Совпадает ли направление отрезка с опорным.
+    bool forward;
+};
+
+double distanceBetween(const Point_2& a, const Point_2& b) {
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+/**
+ * @brief Раскладывает отрезки по прямым с допуском tolerance.
+ *
+ * Отрезки не длиннее допуска ни в одну группу не попадают и считаются в zeroLength.
+ * @return Группы индексов отрезков; в каждой индексы по возрастанию.
+ */
+std::vector<std::vector<std::size_t>> groupByLine(const Lines& lines, double tolerance, std::size_t& zeroLength) {
+    // Квант угла: расхождение направлений на всём размахе штриховки не больше допуска.
+    double extent = 0;
+    if (!lines.empty()) {
+        Point_2 low = lines.front().start, high = low;
+        for (const auto& line : lines) {
+            for (const Point_2& p : { line.start, line.end }) {
+                low = { std::min(low.x, p.x), std::min(low.y, p.y) };
+                high = { std::max(high.x, p.x), std::max(high.y, p.y) };
+            }
+        }
+        extent = std::hypot(high.x - low.x, high.y - low.y);
+    }
+    double angleQuantum = std::max(tolerance / std::max(extent, tolerance), MIN_ANGLE_QUANTUM);
+    auto angleBuckets = static_cast<std::int64_t>(std::ceil(std::numbers::pi / angleQuantum));
+
+    std::unordered_map<LineKey, std::size_t, LineKeyHash> groupOf;
+    groupOf.reserve(lines.size());
+    std::vector<std::vector<std::size_t>> groups;
+    zeroLength = 0;
+
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        const Line_2& line = lines[i];
+        double dx = line.end.x - line.start.x, dy = line.end.y - line.start.y;
+        if (std::hypot(dx, dy) <= tolerance) {
+            ++zeroLength;
+            continue;
+        }
+
+        // Направление по модулю 180 градусов и смещение прямой по перпендикуляру к нему.
+        double theta = std::atan2(dy, dx);
+        if (theta < 0) theta += std::numbers::pi;
+        if (theta >= std::numbers::pi) theta -= std::numbers::pi;
+        double offset = -std::sin(theta) * line.start.x + std::cos(theta) * line.start.y;
+        std::int64_t angleKey = std::min(static_cast<std::int64_t>(std::llround(theta / angleQuantum)), angleBuckets - 1);
+
+        std::optional<std::size_t> found;
+        for (int da = -1; da <= 1 && !found; ++da) {
+            // Через 180 градусов прямая та же, но перпендикуляр - противоположный.
+            std::int64_t a = angleKey + da;
+            double v = offset;
+            if (a < 0 || a >= angleBuckets) {
+                a = (a + angleBuckets) % angleBuckets;
+                v = -v;
+            }
+            auto offsetKey = static_cast<std::int64_t>(std::llround(v / tolerance));
+            for (int dv = -1; dv <= 1 && !found; ++dv) {
+                auto it = groupOf.find({ a, offsetKey + dv });
+                if (it != groupOf.end()) found = it->second;
+            }
+        }
+        if (!found) {
+            found = groups.size();
+            groups.emplace_back();
+            groupOf.emplace(LineKey{ angleKey, static_cast<std::int64_t>(std::llround(offset / tolerance)) }, *found);
+        }
+        groups[*found].push_back(i);
+    }
+    return groups;
+}
+
+/// Интервалы отрезков группы вдоль направления её первого отрезка, по возрастанию начала.
+void projectGroup(const Lines& lines, const std::vector<std::size_t>& members, std::vector<Interval>& intervals) {
+    const Line_2& reference = lines[members.front()];
+    double rx = reference.end.x - reference.start.x, ry = reference.end.y - reference.start.y;
+    double length = std::hypot(rx, ry);
+    rx /= length;
+    ry /= length;
+
+    intervals.clear();
+    for (std::size_t index : members) {
+        const Line_2& line = lines[index];
+        double us = rx * line.start.x + ry * line.start.y;
+        double ue = rx * line.end.x + ry * line.end.y;
+        if (us <= ue) intervals.push_back({ index, us, ue, line.start, line.end, true });
+        else intervals.push_back({ index, ue, us, line.end, line.start, false });
+    }
+    std::sort(intervals.begin(), intervals.end(), [](const Interval& a, const Interval& b) { return a.u0 < b.u0; });
+}
+
+/// Отрезок интервала в исходном направлении.
+Line_2 intervalLine(const Interval& interval) {
+    return interval.forward ? Line_2{ interval.low, interval.high } : Line_2{ interval.high, interval.low };
+}
+
+} // namespace
+
+void mergeSegments(Lines& lines, const MergeOptions& options, MergeStats* stats) {
+    if (!(options.tolerance > 0)) throw std::invalid_argument("Merge tolerance must be positive");
+
+    MergeStats local;
+    local.input = lines.size();
+    std::vector<std::vector<std::size_t>> groups = groupByLine(lines, options.tolerance, local.zeroLength);
+
+    // Слитые отрезки встают на место первого из своих исходных.
+    std::vector<std::optional<Line_2>> slots(lines.size());
+    std::vector<Interval> intervals;
+    for (const auto& members : groups) {
+        projectGroup(lines, members, intervals);
+
+        auto flush = [&](const Interval& run) { slots[run.index] = intervalLine(run); };
+        Interval run = intervals.front();
+        for (std::size_t k = 1; k < intervals.size(); ++k) {
+            const Interval& next = intervals[k];
+            if (next.u0 > run.u1 + options.tolerance) {
+                flush(run);
+                run = next;
+                continue;
+            }
+            ++local.merged;
+            if (next.u1 > run.u1) {
+                run.u1 = next.u1;
+                run.high = next.high;
+            }
+            if (next.index < run.index) {
+                run.index = next.index;
+                run.forward = next.forward;
+            }
+        }
+        flush(run);
+    }
+
+    Lines result(lines.get_allocator());
+    result.reserve(lines.size() - local.zeroLength - local.merged);
+    for (const auto& slot : slots) {
+        if (slot) result.push_back(*slot);
+    }
+    lines = std::move(result);
+
+    local.output = lines.size();
+    if (stats) *stats = local;
+}
+
+void filterShortSegments(Lines& lines, const ShortSegmentOptions& options, ShortSegmentStats* stats) {
+    ShortSegmentStats local;
+    local.input = lines.size();
+    double snap = options.snapDistance > 0 ? options.snapDistance : options.minLength / 2;
+    auto isShort = [&](const Line_2& line) { return distanceBetween(line.start, line.end) < options.minLength; };
+
+    if (options.coalesce) {
+        if (!(options.lineTolerance > 0)) throw std::invalid_argument("Line tolerance must be positive");
+
+        // Соседи ищутся по положению на прямой, а не по порядку прохода: обрезки
+        // плиток и осколки углов отстоят от продолжаемого отрезка на много строк.
+        std::size_t zeroLength = 0;
+        std::vector<std::vector<std::size_t>> groups = groupByLine(lines, options.lineTolerance, zeroLength);
+        std::vector<Interval> intervals;
+        std::vector<std::optional<std::size_t>> previousLong;
+        for (const auto& members : groups) {
+            projectGroup(lines, members, intervals);
+
+            // Ближайший слева длинный отрезок каждого интервала.
+            previousLong.assign(intervals.size(), std::nullopt);
+            std::optional<std::size_t> last;
+            for (std::size_t k = 0; k < intervals.size(); ++k) {
+                previousLong[k] = last;
+                if (!isShort(lines[intervals[k].index])) last = k;
+            }
+
+            // Справа налево: ближайший справа длинный известен на каждом шаге.
+            std::optional<std::size_t> next;
+            for (std::size_t k = intervals.size(); k-- > 0;) {
+                Interval& piece = intervals[k];
+                if (!isShort(lines[piece.index])) {
+                    next = k;
+                    continue;
+                }
+                double leftGap = previousLong[k] ? piece.u0 - intervals[*previousLong[k]].u1 : snap + 1;
+                double rightGap = next ? intervals[*next].u0 - piece.u1 : snap + 1;
+                if (std::min(leftGap, rightGap) > snap) continue;
+
+                ++local.coalesced;
+                lines[piece.index] = {};
+                if (leftGap <= rightGap) {
+                    Interval& host = intervals[*previousLong[k]];
+                    if (piece.u1 > host.u1) {
+                        host.u1 = piece.u1;
+                        host.high = piece.high;
+                    }
+                }
+                else {
+                    Interval& host = intervals[*next];
+                    if (piece.u0 < host.u0) {
+                        host.u0 = piece.u0;
+                        host.low = piece.low;
+                    }
+                }
+            }
+            for (const Interval& interval : intervals) {
+                if (!isShort(lines[interval.index])) lines[interval.index] = intervalLine(interval);
+            }
+        }
+    }
+
+    // Поглощённые отрезки обнулены и отбрасываются вместе с остальными короткими.
+    Lines result(lines.get_allocator());
+    result.reserve(lines.size());
+    for (const Line_2& line : lines) {
+        if (!isShort(line)) result.push_back(line);
+    }
+    local.output = result.size();
+    local.dropped = local.input - local.output - local.coalesced;
+    lines = std::move(result);
+
+    if (stats) *stats = local;
+}
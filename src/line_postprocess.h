@@ -0,0 +1,96 @@
+﻿/**
+ * @file line_postprocess.h
+ * @brief Постобработка готовой штриховки: слияние и удаление лишних отрезков.
+ *
+ * Обрезка соседних плиток, несколько проходов и почти коллинеарные рёбра
+ * контуров дают отрезки, лежащие на одной прямой и касающиеся или
+ * перекрывающиеся, а clipLine на углу прямоугольника - отрезки нулевой длины.
+ * Станок тратит на них время разгона, файл - место.
+ *
+ * Отрезки раскладываются по хэшу от (угол, смещение) их прямой, квантованных
+ * с допуском: угол по модулю 180 градусов, смещение - по перпендикуляру.
+ * Соседние ячейки хэша тоже проверяются, так что прямые, отличающиеся
+ * меньше допуска, попадают в одну группу даже на границе ячейки. Внутри
+ * группы интервалы сортируются вдоль прямой и сливаются, если зазор не
+ * больше допуска. Слитый отрезок встаёт на место первого из своих
+ * отрезков и сохраняет его направление, так что порядок прохода не
+ * перемешивается.
+ *
+ * Короткие отрезки (осколки clipLine на углах, обрезки плиток) гальваносканер
+ * проходит почти целиком в разгоне. Фильтр длины удаляет их, а при слиянии
+ * с соседями (coalesce) короткий отрезок продлевает ближайший длинный
+ * отрезок на той же прямой вместо того, чтобы пропасть. Соседи ищутся по
+ * положению, той же раскладкой по (угол, смещение), что и при слиянии:
+ * в порядке прохода продолжаемая строка соседней плитки отстоит от обрезка
+ * на десятки отрезков.
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <cstddef>
+
+/**
+ * @brief Параметры слияния.
+ */
+struct MergeOptions {
+    /// Допуск: длина "нулевого" отрезка, расстояние между "одной" прямой и зазор между касающимися.
+    double tolerance = 1e-6;
+};
+
+/**
+ * @brief Итоги слияния.
+ */
+struct MergeStats {
+    std::size_t input = 0;
+    /// Отброшено отрезков нулевой (не больше допуска) длины.
+    std::size_t zeroLength = 0;
+    /// Отрезков, поглощённых соседями на той же прямой.
+    std::size_t merged = 0;
+    std::size_t output = 0;
+};
+
+/**
+ * @brief Сливает коллинеарные касающиеся отрезки и удаляет нулевые.
+ * @param lines Линии (заменяются результатом).
+ * @param options Параметры.
+ * @param stats Итоги (необязательно).
+ * @throws std::invalid_argument если допуск не положителен.
+ */
+void mergeSegments(Lines& lines, const MergeOptions& options = {}, MergeStats* stats = nullptr);
+
+/**
+ * @brief Параметры фильтра коротких отрезков.
+ */
+struct ShortSegmentOptions {
+    /// Отрезки короче этой длины не выдаются.
+    double minLength = 0;
+    /// Продлевать соседние отрезки короткими вместо удаления.
+    bool coalesce = false;
+    /// Наибольший зазор вдоль прямой между коротким отрезком и продлеваемым; 0 - minLength / 2.
+    double snapDistance = 0;
+    /// Отклонение, при котором отрезки считаются лежащими на одной прямой.
+    double lineTolerance = 1e-6;
+};
+
+/**
+ * @brief Итоги фильтра коротких отрезков.
+ */
+struct ShortSegmentStats {
+    std::size_t input = 0;
+    /// Удалено коротких отрезков.
+    std::size_t dropped = 0;
+    /// Коротких отрезков, поглощённых соседями.
+    std::size_t coalesced = 0;
+    std::size_t output = 0;
+};
+
+/**
+ * @brief Удаляет или сливает с соседями отрезки короче minLength.
+ * @param lines Линии в порядке прохода (заменяются результатом).
+ * @param options Параметры.
+ * @param stats Итоги (необязательно).
+ * @throws std::invalid_argument если при coalesce допуск прямой не положителен.
+ */
+void filterShortSegments(Lines& lines, const ShortSegmentOptions& options, ShortSegmentStats* stats = nullptr);
@@ -2,231 +2,534 @@
  * @file main.cpp
  * @brief Основная точка входа программы hatch_generator.
  *
- * Программа генерирует линии (штриховку) под заданным углом и шагом,
- * выполняет обрезку линий алгоритмом Коэна–Сазерленда и сохраняет результат в SVG-файл.
+ * Программа генерирует линии (штриховку) под заданным углом и шагом внутри
+ * контуров (прямоугольник - аналитически, остальные - по индексу рёбер)
+ * и сохраняет результат в SVG-файл.
  *
  * Поддерживаемые параметры:
  * - `--angle <число>` - угол наклона линий в градусах.
  * - `--step <число>` - расстояние между линиями.
+ * - `--dxf <путь>` - читать контуры из DXF вместо встроенного прямоугольника.
+ * - `--dxf-tolerance <число>` - точность аппроксимации дуг (bulge) при чтении DXF;
+ *   по умолчанию берётся доля шага штриховки.
+ * - `--cache-dir <путь>` - каталог дискового кэша результатов штриховки.
+ * - `--cache-max-mb <число>` - предельный размер кэша в мегабайтах.
+ * - `--serve <сокет>` - работать сервером на Unix-сокете (`--threads <число>` - размер пула).
+ * - `--client <сокет>` - отправить задание серверу; `--format svg|bin` и `--output <путь>`
+ *   задают формат и файл результата.
+ * - `--load <сокет>` - генератор нагрузки (`--requests <число>`, `--connections <число>`).
+ * - `--clip-dxf <путь>` - дополнительно обрезать штриховку по области из DXF.
+ * - `--batch <список>` - пакетная обработка DXF-файлов конвейером
+ *   (`--threads <число>` - потоки штриховки).
+ * - `--inset <число>` - отступ штриховки внутрь контура (радиус пятна или
+ *   инструмента); отрицательное значение расширяет область.
+ * - `--perimeters <число>` - число периметров (концентрических проходов вдоль
+ *   контура) перед штриховкой; `--perimeter-spacing <число>` - расстояние между
+ *   ними (по умолчанию шаг штриховки).
+ * - `--pattern lines|concentric|spiral|grid|triangles|hexagons|gyroid` - узор
+ *   заполнения: параллельные линии (по умолчанию), концентрические эквидистанты,
+ *   архимедова спираль или решётка; `--density <число>` - доля площади под
+ *   дорожками решётки (по умолчанию 0.2).
+ * - `--max-step <число>` - переменный шаг: у контура `--step`, в глубине до
+ *   `--max-step`; `--falloff <число>` - расстояние от контура, на котором шаг
+ *   достигает наибольшего (по умолчанию `--max-step`).
+ * - `--tiles stripes|chessboard` - штриховка по плиткам (полосы или квадраты
+ *   `--tile-size <число>`, по умолчанию 5), угол соседних плиток отличается на
+ *   `--tile-rotation <градусы>` (по умолчанию 90); плитки штрихуются в
+ *   `--threads <число>` потоков.
+ * - `--merge-lines` - слить коллинеарные касающиеся отрезки и удалить нулевые
+ *   (`--merge-tolerance <число>` - допуск, по умолчанию 1e-6).
+ * - `--min-length <число>` - не выдавать отрезки короче заданной длины;
+ *   с `--coalesce` короткие отрезки продлевают соседей на той же прямой.
+ * - `--bench <набор>` - встроенные замеры производительности (`offset`,
+ *   `rectangle`, `dxf`, `predicates`).
+ * - `--preview <путь>` - дополнительно сохранить растровый предпросмотр
+ *   (`.png` - PNG, иначе PGM); `--preview-size <пиксели>` - длинная сторона
+ *   (по умолчанию 2048), рисуется в `--threads <число>` потоков.
  *
- * Результат сохраняется в файл `hatch.svg` в папке сборки.
+ * Результат сохраняется в файл `hatch.svg` в папке сборки (`--format` и
+ * `--output` задают другой формат и файл).
  */
 
+#include "geometry.h"
+#include "adaptive_hatch.h"
+#include "batch_pipeline.h"
+#include "benchmark.h"
+#include "curves.h"
+#include "dxf_reader.h"
+#include "fill_pattern.h"
+#include "hatch_session.h"
+#include "hatcher.h"
+#include "lattice_pattern.h"
+#include "line_postprocess.h"
+#include "offset.h"
+#include "perimeter.h"
+#include "polygon_clip.h"
+#include "raster_preview.h"
+#include "output_writers.h"
+#include "server.h"
+#include "result_cache.h"
+#include "robust_predicates.h"
+#include "tiled_hatch.h"
+
 #include <iostream>
 #include <vector>
 #include <cmath>
-#include <numbers>
 #include <fstream>
 #include <string>
-
- /**
-  * @brief Точка в 2D пространстве.
-  */
-struct Point_2 {
-    /**
-     * @brief Координата X.
-     */
-    double x;
-
-    /**
-     * @brief Координата Y.
-     */
-    double y;
-};
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include <optional>
 
 /**
- * @brief Линия, представленная двумя точками (начало и конец).
- */
-struct Line_2 {
-    /**
-     * @brief Начальная точка линии.
-     */
-    Point_2 start;
-
-    /**
-     * @brief Конечная точка линии.
-     */
-    Point_2 end;
-};
-
-/// Контур - список точек.
-using Contour = std::vector<Point_2>;
-/// Коллекция контуров.
-using Contours = std::vector<Contour>;
-/// Коллекция линий.
-using Lines = std::vector<Line_2>;
-
-/**
- * @brief Конвертирует угол из градусов в радианы.
- * @param degrees Угол в градусах.
- * @return Угол в радианах.
+ * @brief Отправляет один запрос серверу и сохраняет ответ в файл.
+ * @param socketPath Путь к сокету сервера.
+ * @param request Запрос.
+ * @param outputPath Файл для результата.
+ * @return Код выхода.
  */
-double degreesToRadians(double degrees) { return degrees * std::numbers::pi / 180.0; }
+int runClient(const std::string& socketPath, const HatchRequest& request, const std::string& outputPath) {
+    HatchClient client(socketPath);
+    HatchResponse response;
+    client.call(request, response);
+
+    if (!response.ok) {
+        std::cerr << "Server error: " << response.payload << "\n";
+        return 1;
+    }
 
-/**
- * @enum OutCode
- * @brief Коды положения точки относительно прямоугольника
- * (используются в алгоритме Коэна–Сазерленда).
- *
- * INSIDE – внутри
- * LEFT / RIGHT – вне по X
- * BOTTOM / TOP – вне по Y
- */
-enum OutCode { INSIDE = 0, LEFT = 1, RIGHT = 2, BOTTOM = 4, TOP = 8 };
+    std::ofstream out(outputPath, std::ios::binary);
+    out.write(response.payload.data(), static_cast<std::streamsize>(response.payload.size()));
+    std::cout << "Result written: " << outputPath << " (" << response.payload.size() << " bytes)\n";
+    return 0;
+}
 
 /**
- * @brief Вычисляет OutCode для точки относительно прямоугольника.
- * @param x Координата X точки.
- * @param y Координата Y точки.
- * @param bottomLeft Нижняя левая точка прямоугольника.
- * @param topRight Верхняя правая точка прямоугольника.
- * @return Код положения.
+ * @brief Прогоняет нагрузочный тест против сервера и печатает итоги.
+ * @param options Параметры прогона.
+ * @param request Запрос, повторяемый в каждом обращении.
+ * @return Код выхода.
  */
-int computeOutCode(double x, double y, const Point_2& bottomLeft, const Point_2& topRight) {
-    int code = INSIDE;
-    if (x < bottomLeft.x) code |= LEFT;
-    else if (x > topRight.x) code |= RIGHT;
-
-    if (y < bottomLeft.y) code |= BOTTOM;
-    else if (y > topRight.y) code |= TOP;
-
-    return code;
+int runLoad(const LoadTestOptions& options, const HatchRequest& request) {
+    LoadTestReport report = runLoadTest(options, request);
+    double seconds = report.elapsed.count();
+
+    std::cout << "Requests: " << report.completed << ", errors: " << report.errors << "\n"
+        << "Throughput: " << (seconds > 0 ? report.completed / seconds : 0) << " req/s\n"
+        << "Latency p50: " << report.p50.count() << " us, p99: " << report.p99.count()
+        << " us, max: " << report.max.count() << " us\n";
+    return report.errors == 0 ? 0 : 1;
 }
 
 /**
- * @brief Обрезает линию в пределах прямоугольника по алгоритму Коэна–Сазерленда.
- *
- * @param line Линия для обрезки. На выходе содержит усечённую версию.
- * @param bottomLeft Нижняя левая точка ограничивающего прямоугольника.
- * @param topRight Верхняя правая точка прямоугольника.
- * @return true, если линия пересекает прямоугольник и была обрезана;
- *         false, если линия полностью вне прямоугольника.
+ * @brief Выполняет пакет заданий конвейером и печатает итоги по стадиям.
+ * @param items Задания.
+ * @param options Параметры конвейера.
+ * @return Код выхода.
  */
-bool clipLine(Line_2& line, const Point_2& bottomLeft, const Point_2& topRight) {
-    double x0 = line.start.x, y0 = line.start.y;
-    double x1 = line.end.x, y1 = line.end.y;
-
-    int outcode0 = computeOutCode(x0, y0, bottomLeft, topRight);
-    int outcode1 = computeOutCode(x1, y1, bottomLeft, topRight);
-    bool accept = false;
-
-    while (true) {
-        if (!(outcode0 | outcode1)) {   // Оба внутри
-            accept = true;
-            break;
-        }
-        else if (outcode0 & outcode1) { // Полностью вне
-            break;
-        }
-        else {
-            double x, y;
-            int outcodeOut = outcode0 ? outcode0 : outcode1;
-
-            if (outcodeOut & TOP) {
-                x = x0 + (x1 - x0) * (topRight.y - y0) / (y1 - y0);
-                y = topRight.y;
-            }
-            else if (outcodeOut & BOTTOM) {
-                x = x0 + (x1 - x0) * (bottomLeft.y - y0) / (y1 - y0);
-                y = bottomLeft.y;
-            }
-            else if (outcodeOut & RIGHT) {
-                y = y0 + (y1 - y0) * (topRight.x - x0) / (x1 - x0);
-                x = topRight.x;
-            }
-            else { // LEFT
-                y = y0 + (y1 - y0) * (bottomLeft.x - x0) / (x1 - x0);
-                x = bottomLeft.x;
-            }
-
-            if (outcodeOut == outcode0) {
-                x0 = x; y0 = y;
-                outcode0 = computeOutCode(x0, y0, bottomLeft, topRight);
-            }
-            else {
-                x1 = x; y1 = y;
-                outcode1 = computeOutCode(x1, y1, bottomLeft, topRight);
-            }
-        }
-    }
-
-    if (accept) {
-        line.start = { x0, y0 };
-        line.end = { x1, y1 };
-        return true;
-    }
-    return false;
+int runBatch(const std::vector<BatchItem>& items, const BatchOptions& options) {
+    BatchReport report = runBatchPipeline(items, options);
+
+    for (const auto& error : report.errors)
+        std::cerr << error << "\n";
+
+    std::cout << "Batch: " << report.jobs << " jobs, " << report.failed << " failed, " << report.lines << " lines";
+    // С узором результат - ломаные, а не линии.
+    if (report.polylines > 0) std::cout << ", " << report.polylines << " polylines (" << report.points << " points)";
+    std::cout << " in " << report.elapsed.count() << " s\n"
+        << "Stage busy time: read " << report.readTime.count()
+        << " s, hatch " << report.hatchTime.count()
+        << " s, write " << report.writeTime.count() << " s\n"
+        << "Arena peak per job: " << report.arenaPeakBytes << " bytes\n";
+    return report.failed == 0 ? 0 : 1;
 }
 
 /**
  * @brief Точка входа программы.
  *
  * Разбирает аргументы командной строки, генерирует набор линий под углом,
- * выполняет обрезку по прямоугольнику и записывает результат в SVG.
+ * выполняет обрезку по прямоугольнику (или по произвольным контурам через
+ * индекс рёбер) и записывает результат в SVG.
  *
  * @param argc Количество аргументов.
  * @param argv Массив аргументов.
  * @return Код выхода.
  */
 int main(int argc, char* argv[]) {
+    CurvedContours curvedContours;
     Contours contoursPoints;
     Lines hatchLines;
 
-    // --- Пример исходного прямоугольника ---
-    contoursPoints.push_back({ {0,0}, {20,0}, {20,10}, {0,10} });
-    Point_2 bottomLeft = contoursPoints[0][0];
-    Point_2 topRight = contoursPoints[0][2];
-
     // --- Разбор аргументов ---
     double angleDegrees = 45;
     double step = 1;
+    std::string dxfPath;
+    double dxfTolerance = 0;
+    std::string cacheDir;
+    double cacheMaxMegabytes = 256;
+    std::string serveSocket;
+    std::string clientSocket;
+    std::string loadSocket;
+    std::size_t threads = 0;
+    std::size_t loadRequests = 1000;
+    std::size_t loadConnections = 4;
+    OutputFormat outputFormat = OutputFormat::Svg;
+    std::string outputPath;
+    std::string batchList;
+    std::string clipDxfPath;
+    double inset = 0;
+    std::size_t perimeterCount = 0;
+    double perimeterSpacing = 0;
+    std::string benchName;
+    std::string patternName = "lines";
+    double density = DEFAULT_LATTICE_DENSITY;
+    double maxStep = 0;
+    double falloff = 0;
+    std::string tileModeName;
+    TilingOptions tiling;
+    bool mergeLines = false;
+    MergeOptions mergeOptions;
+    ShortSegmentOptions shortOptions;
+    std::string previewPath;
+    PreviewOptions previewOptions;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--angle" && i + 1 < argc) angleDegrees = std::stod(argv[++i]);
         else if (arg == "--step" && i + 1 < argc) step = std::stod(argv[++i]);
+        else if (arg == "--dxf" && i + 1 < argc) dxfPath = argv[++i];
+        else if (arg == "--dxf-tolerance" && i + 1 < argc) dxfTolerance = std::stod(argv[++i]);
+        else if (arg == "--cache-dir" && i + 1 < argc) cacheDir = argv[++i];
+        else if (arg == "--cache-max-mb" && i + 1 < argc) cacheMaxMegabytes = std::stod(argv[++i]);
+        else if (arg == "--serve" && i + 1 < argc) serveSocket = argv[++i];
+        else if (arg == "--client" && i + 1 < argc) clientSocket = argv[++i];
+        else if (arg == "--load" && i + 1 < argc) loadSocket = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) threads = std::stoul(argv[++i]);
+        else if (arg == "--requests" && i + 1 < argc) loadRequests = std::stoul(argv[++i]);
+        else if (arg == "--connections" && i + 1 < argc) loadConnections = std::stoul(argv[++i]);
+        else if (arg == "--format" && i + 1 < argc)
+            outputFormat = std::string(argv[++i]) == "bin" ? OutputFormat::Binary : OutputFormat::Svg;
+        else if (arg == "--output" && i + 1 < argc) outputPath = argv[++i];
+        else if (arg == "--batch" && i + 1 < argc) batchList = argv[++i];
+        else if (arg == "--clip-dxf" && i + 1 < argc) clipDxfPath = argv[++i];
+        else if (arg == "--inset" && i + 1 < argc) inset = std::stod(argv[++i]);
+        else if (arg == "--perimeters" && i + 1 < argc) perimeterCount = std::stoul(argv[++i]);
+        else if (arg == "--perimeter-spacing" && i + 1 < argc) perimeterSpacing = std::stod(argv[++i]);
+        else if (arg == "--bench" && i + 1 < argc) benchName = argv[++i];
+        else if (arg == "--pattern" && i + 1 < argc) patternName = argv[++i];
+        else if (arg == "--density" && i + 1 < argc) density = std::stod(argv[++i]);
+        else if (arg == "--max-step" && i + 1 < argc) maxStep = std::stod(argv[++i]);
+        else if (arg == "--falloff" && i + 1 < argc) falloff = std::stod(argv[++i]);
+        else if (arg == "--tiles" && i + 1 < argc) tileModeName = argv[++i];
+        else if (arg == "--tile-size" && i + 1 < argc) tiling.size = std::stod(argv[++i]);
+        else if (arg == "--tile-rotation" && i + 1 < argc) tiling.rotation = std::stod(argv[++i]);
+        else if (arg == "--merge-lines") mergeLines = true;
+        else if (arg == "--merge-tolerance" && i + 1 < argc) mergeOptions.tolerance = std::stod(argv[++i]);
+        else if (arg == "--min-length" && i + 1 < argc) shortOptions.minLength = std::stod(argv[++i]);
+        else if (arg == "--coalesce") shortOptions.coalesce = true;
+        else if (arg == "--preview" && i + 1 < argc) previewPath = argv[++i];
+        else if (arg == "--preview-size" && i + 1 < argc) previewOptions.size = std::stoul(argv[++i]);
     }
 
-    double angleRadians = degreesToRadians(angleDegrees);
+    // --- Замеры производительности ---
+    if (!benchName.empty()) {
+        try {
+            runBenchmark(benchName, std::cout);
+            return 0;
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
 
-    double width = topRight.x - bottomLeft.x;
-    double height = topRight.y - bottomLeft.y;
-    double diagonal = std::sqrt(width * width + height * height);
+    // --- Режим сервера ---
+    if (!serveSocket.empty()) {
+        try {
+            std::cout << "Serving on " << serveSocket << "\n";
+            return runServer({ serveSocket, threads });
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
 
-    Point_2 center{
-        (bottomLeft.x + topRight.x) / 2,
-        (bottomLeft.y + topRight.y) / 2
-    };
+    // --- Пакетный режим ---
+    if (!batchList.empty()) {
+        try {
+            BatchOptions options;
+            options.angleDegrees = angleDegrees;
+            options.step = step;
+            options.tolerance = dxfTolerance;
+            options.inset = inset;
+            options.perimeters = perimeterCount;
+            options.perimeterSpacing = perimeterSpacing;
+            options.pattern = patternName;
+            options.density = density;
+            options.format = outputFormat;
+            options.hatchThreads = threads;
+            return runBatch(readBatchList(batchList, outputFormat), options);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
 
-    // --- Генерация линий ---
-    if (angleDegrees == 0) {
-        for (double y = bottomLeft.y; y <= topRight.y; y += step) {
-            hatchLines.push_back({ {bottomLeft.x, y}, {topRight.x, y} });
+    // --- Исходные контуры ---
+    if (dxfPath.empty()) {
+        // Пример исходного прямоугольника
+        curvedContours.push_back(CurvedContour::fromPolygon({ {0,0}, {20,0}, {20,10}, {0,10} }));
+    }
+    else {
+        try {
+            curvedContours = readDxfCurvedFile(dxfPath);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
         }
+        std::cout << "Contours read from DXF: " << curvedContours.size() << "\n";
     }
-    else if (angleDegrees == 90) {
-        for (double x = bottomLeft.x; x <= topRight.x; x += step) {
-            hatchLines.push_back({ {x, bottomLeft.y}, {x, topRight.y} });
+
+    // --- Режимы клиента и генератора нагрузки ---
+    if (!clientSocket.empty() || !loadSocket.empty()) {
+        HatchRequest request;
+        request.format = outputFormat;
+        request.angleDegrees = angleDegrees;
+        request.step = step;
+        request.contours = flattenContours(curvedContours,
+            dxfTolerance > 0 ? dxfTolerance : flatteningToleranceForStep(step));
+
+        try {
+            if (!clientSocket.empty()) {
+                if (outputPath.empty()) outputPath = outputFormat == OutputFormat::Svg ? "hatch.svg" : "hatch.bin";
+                return runClient(clientSocket, request, outputPath);
+            }
+            return runLoad({ loadSocket, loadRequests, loadConnections }, request);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (!tileModeName.empty()) {
+        if (tileModeName == "stripes") tiling.mode = TileMode::Stripes;
+        else if (tileModeName == "chessboard") tiling.mode = TileMode::Chessboard;
+        else {
+            std::cerr << "Unknown tile mode: " << tileModeName << "\n";
+            return 1;
+        }
+        tiling.threads = threads;
+    }
+
+    // Узор, отличный от линий, заполняет область ломаными вместо штриховки.
+    std::unique_ptr<FillPattern> pattern;
+    if (patternName != "lines") {
+        try {
+            pattern = makeFillPattern(patternName, angleDegrees, density);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    std::optional<HatchResultCache> cache;
+    if (!cacheDir.empty()) {
+        try {
+            cache.emplace(cacheDir, static_cast<std::uintmax_t>(cacheMaxMegabytes * 1024 * 1024));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Cache disabled: " << e.what() << "\n";
+        }
+    }
+
+    // Контур детали для вывода; при отступе и периметрах штрихуется область внутри них.
+    Contours outline;
+    Polylines perimeters;
+    if (inset != 0 || perimeterCount > 0) {
+        double tolerance = dxfTolerance > 0 ? dxfTolerance : flatteningToleranceForStep(step);
+        outline = flattenContours(curvedContours, tolerance);
+
+        Contours infill;
+        if (perimeterCount > 0) {
+            PerimeterOptions options;
+            options.count = perimeterCount;
+            options.spacing = perimeterSpacing > 0 ? perimeterSpacing : step;
+            options.inset = inset;
+            perimeters = generatePerimeters(outline, options, &infill);
+            std::cout << "Perimeters: " << perimeters.size() << " loops, infill " << infill.size() << " contours\n";
+        }
+        else {
+            OffsetStats offsetStats;
+            infill = offsetContours(outline, -inset, {}, &offsetStats);
+            std::cout << "Inset " << inset << ": " << outline.size() << " -> " << offsetStats.contours
+                << " contours (" << offsetStats.intersections << " intersections)\n";
+        }
+
+        curvedContours.clear();
+        for (const auto& contour : infill)
+            curvedContours.push_back(CurvedContour::fromPolygon(contour));
+    }
+
+    // Сессия держит подготовленную геометрию; тот же объект использует интерактивный просмотр.
+    HatchSession session(std::move(curvedContours), dxfTolerance);
+    contoursPoints = session.prepare(step);
+    if (inset == 0 && perimeterCount == 0) outline = contoursPoints;
+
+    Point_2 bottomLeft{};
+    Point_2 topRight{};
+    bool hasInfill = computeBounds(contoursPoints, bottomLeft, topRight);
+    if (!hasInfill && perimeters.empty()) {
+        std::cerr << "No closed contours to hatch\n";
+        return 1;
+    }
+
+    // Дополнительная область обрезки (зоны платформы, маски исключения).
+    Contours clipRegion;
+    if (!clipDxfPath.empty()) {
+        try {
+            clipRegion = readDxfFile(clipDxfPath, dxfTolerance > 0 ? dxfTolerance : flatteningToleranceForStep(step));
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    // --- Генерация линий ---
+    Polylines patternPaths;
+    if (pattern) {
+        if (hasInfill) pattern->fill(contoursPoints, step, patternPaths);
+        std::size_t points = 0;
+        for (const auto& polyline : patternPaths) points += polyline.size();
+        std::cout << "Pattern " << pattern->name() << ": " << patternPaths.size() << " polylines, "
+            << points << " points\n";
+
+        if (!clipRegion.empty()) {
+            PolygonClipper clipper(clipRegion);
+            Polylines clipped;
+            for (const auto& polyline : patternPaths) clipper.clipPolyline(polyline, clipped);
+            patternPaths = std::move(clipped);
+            std::cout << "Clipped by region: " << clipper.stats().segments << " segments -> "
+                << clipper.stats().pieces << " polylines\n";
         }
     }
     else {
-        for (double offset = -diagonal / 2; offset <= diagonal / 2; offset += step) {
-            Point_2 dir{ std::cos(angleRadians), std::sin(angleRadians) };
-            Point_2 perp{ -dir.y, dir.x };
+        bool rectangular = isAxisAlignedRectangle(contoursPoints);
+        bool adaptive = maxStep > step;
+        // Углы, равные по модулю 180 (0/180/360, -45/135), дают одну штриховку и одну запись кэша.
+        double hatchAngle = normalizeHatchAngle(angleDegrees);
+        HatchCacheKeyBuilder keyBuilder;
+        keyBuilder.add(contoursPoints).add(hatchAngle).add(step)
+            .add(rectangular ? "rectangle" : "even-odd")
+            .add(clipRegion);
+        if (adaptive) keyBuilder.add("adaptive").add(maxStep).add(falloff);
+        if (!tileModeName.empty()) keyBuilder.add(tileModeName).add(tiling.size).add(tiling.rotation);
+        HatchCacheKey cacheKey = keyBuilder.key();
+
+        if (cache && cache->get(cacheKey, hatchLines)) {
+            std::cout << "Hatch loaded from cache: " << cacheKey.hex() << "\n";
+        }
+        else {
+            if (!hasInfill) {
+                // Периметры заняли всю деталь - штриховать нечего.
+            }
+            else if (!tileModeName.empty()) {
+                // Плитки штрихуются по своим индексам рёбер; переменный шаг здесь не применяется.
+                TilingStats tilingStats;
+                try {
+                    hatchTiled(contoursPoints, hatchAngle, step, tiling, hatchLines, &tilingStats);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << e.what() << "\n";
+                    return 1;
+                }
+                std::cout << "Tiles (" << tileModeName << "): " << tilingStats.tiles << " tiles, "
+                    << tilingStats.emptyTiles << " empty, " << tilingStats.angles << " angles\n";
+            }
+            else if (adaptive) {
+                AdaptiveStepOptions options;
+                options.minStep = step;
+                options.maxStep = maxStep;
+                options.falloff = falloff;
+                AdaptiveHatchStats adaptiveStats;
+                try {
+                    hatchAdaptive(contoursPoints, hatchAngle, options, hatchLines, &adaptiveStats);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << e.what() << "\n";
+                    return 1;
+                }
+                double saved = adaptiveStats.uniformLength > 0
+                    ? 100 * (1 - adaptiveStats.adaptiveLength / adaptiveStats.uniformLength) : 0;
+                std::cout << "Adaptive step " << step << ".." << maxStep << ": path length "
+                    << adaptiveStats.adaptiveLength << " vs " << adaptiveStats.uniformLength
+                    << " at constant step (saved " << saved << "%, field " << adaptiveStats.fieldCells << " cells)\n";
+            }
+            else if (!rectangular) {
+                // Произвольные контуры: пересечения ищутся через индекс рёбер.
+                hatchLines = session.update(hatchAngle, step);
+                std::cout << "Hatch update: " << session.lastUpdate().latency.count() << " us\n";
+            }
+            else {
+                hatchRectangle(bottomLeft, topRight, hatchAngle, step, hatchLines);
+            }
 
-            Line_2 line;
-            line.start = { center.x + perp.x * offset - dir.x * diagonal / 2,
-                           center.y + perp.y * offset - dir.y * diagonal / 2 };
+            if (!clipRegion.empty()) {
+                PolygonClipper clipper(clipRegion);
+                Lines clipped;
+                clipper.clipBatch(hatchLines, clipped);
+                hatchLines = std::move(clipped);
+                std::cout << "Clipped by region (" << (clipper.isConvex() ? "convex" : "general") << "): "
+                    << clipper.stats().segments << " -> " << clipper.stats().pieces << " segments\n";
+            }
+
+            if (cache) cache->put(cacheKey, hatchLines);
+        }
+    }
+
+    if (cache) {
+        const HatchCacheStats& stats = cache->stats();
+        std::cout << "Cache: hits=" << stats.hits << " misses=" << stats.misses
+            << " evictions=" << stats.evictions << " bytes=" << stats.bytes << "\n";
+    }
 
-            line.end = { center.x + perp.x * offset + dir.x * diagonal / 2,
-                           center.y + perp.y * offset + dir.y * diagonal / 2 };
+    PredicateStats predicates = predicateStats();
+    if (predicates.fallbacks > 0) std::cout << "Exact orientation fallbacks: " << predicates.fallbacks << "\n";
 
-            if (clipLine(line, bottomLeft, topRight))
-                hatchLines.push_back(line);
+    // --- Постобработка ---
+    if (mergeLines) {
+        MergeStats mergeStats;
+        try {
+            mergeSegments(hatchLines, mergeOptions, &mergeStats);
         }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        std::cout << "Merge: " << mergeStats.input << " -> " << mergeStats.output << " segments ("
+            << mergeStats.merged << " merged, " << mergeStats.zeroLength << " zero-length)\n";
+    }
+
+    if (shortOptions.minLength > 0) {
+        ShortSegmentStats shortStats;
+        filterShortSegments(hatchLines, shortOptions, &shortStats);
+        std::cout << "Short segments (< " << shortOptions.minLength << "): " << shortStats.dropped << " dropped, "
+            << shortStats.coalesced << " coalesced, " << shortStats.output << " left\n";
     }
 
     // --- Лог вывод ---
+    int perimeterNumber = 1;
+    for (const auto& polyline : perimeters) {
+        std::cout << "Perimeter " << perimeterNumber++ << ": " << polyline.size() << " points from ("
+            << polyline.front().x << "," << polyline.front().y << ")\n";
+    }
+
     int lineNumber = 1;
     for (const auto& line : hatchLines) {
         std::cout << "Line " << lineNumber++
@@ -234,37 +537,39 @@ int main(int argc, char* argv[]) {
             << ") -> (" << line.end.x << "," << line.end.y << ")\n";
     }
 
-    // --- Генерация SVG ---
-    std::ofstream svg("hatch.svg");
-    double scale = 10.0;
-
-    svg << "<svg xmlns='http://www.w3.org/2000/svg' width='300' height='200'>\n";
+    // --- Запись результата ---
+    // Траектории узора выполняются после периметров, в том же блоке ломаных.
+    for (auto& polyline : patternPaths) perimeters.push_back(std::move(polyline));
 
-    for (const auto& line : hatchLines) {
-        svg << "<line x1='" << line.start.x * scale
-            << "' y1='" << line.start.y * scale
-            << "' x2='" << line.end.x * scale
-            << "' y2='" << line.end.y * scale
-            << "' stroke='black' stroke-width='0.5'/>\n";
+    if (outputFormat == OutputFormat::Svg) {
+        if (outputPath.empty()) outputPath = "hatch.svg";
+        std::ofstream svg(outputPath);
+        writeSvg(svg, perimeters, hatchLines, outline);
+        svg.close();
+        std::cout << "SVG file generated: " << outputPath << "\n";
     }
-
-    // Рисуем прямоугольник
-    Contour rect = contoursPoints[0];
-    for (size_t i = 0; i < rect.size(); ++i) {
-        Point_2 p1 = rect[i];
-        Point_2 p2 = rect[(i + 1) % rect.size()];
-
-        svg << "<line x1='" << p1.x * scale
-            << "' y1='" << p1.y * scale
-            << "' x2='" << p2.x * scale
-            << "' y2='" << p2.y * scale
-            << "' stroke='red' stroke-width='1'/>\n";
+    else {
+        if (outputPath.empty()) outputPath = "hatch.bin";
+        std::ofstream bin(outputPath, std::ios::binary);
+        writeBinary(bin, hatchLines, perimeters);
+        bin.close();
+        std::cout << "Binary file generated: " << outputPath << "\n";
     }
 
-    svg << "</svg>";
-    svg.close();
-
-    std::cout << "SVG file generated: hatch.svg\n";
+    if (!previewPath.empty()) {
+        previewOptions.threads = threads;
+        try {
+            GrayImage image = renderPreview(perimeters, hatchLines, outline, previewOptions);
+            std::ofstream preview(previewPath, std::ios::binary);
+            if (previewPath.ends_with(".png")) writePng(preview, image);
+            else writePgm(preview, image);
+            std::cout << "Preview generated: " << previewPath << " (" << image.width() << "x" << image.height() << ")\n";
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
     system("pause");
     return 0;
 }
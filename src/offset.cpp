@@ -0,0 +1,683 @@
+﻿/**
+ * @file offset.cpp
+ * @brief Реализация эквидистанты контуров на целочисленной сетке.
+ */
+
+#include "offset.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <set>
+#include <vector>
+
+namespace {
+
+/// Полуразмер сетки: произведения разностей координат (< 2^26) точны в int64 и double.
+constexpr double GRID_HALF_EXTENT = 16777216.0; // 2^24
+/// Максимум отрезков на скругление одного угла.
+constexpr int MAX_ARC_STEPS = 256;
+
+struct IPoint {
+    std::int64_t x = 0;
+    std::int64_t y = 0;
+
+    bool operator==(const IPoint& other) const { return x == other.x && y == other.y; }
+};
+
+struct IEdge {
+    IPoint a;
+    IPoint b;
+};
+
+using IPath = std::vector<IPoint>;
+
+std::int64_t cross(const IPoint& o, const IPoint& a, const IPoint& b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+int sign(std::int64_t value) {
+    return (value > 0) - (value < 0);
+}
+
+std::int64_t signedArea2(const IPath& path) {
+    std::int64_t area = 0;
+    for (std::size_t i = 0; i < path.size(); ++i) {
+        const IPoint& a = path[i];
+        const IPoint& b = path[(i + 1) % path.size()];
+        area += a.x * b.y - b.x * a.y;
+    }
+    return area;
+}
+
+/**
+ * @brief Перевод координат на сетку и обратно (центр - середина рамки).
+ */
+struct GridTransform {
+    double centerX = 0;
+    double centerY = 0;
+    double scale = 1;
+
+    IPoint toGrid(const Point_2& p) const {
+        return { std::llround((p.x - centerX) * scale), std::llround((p.y - centerY) * scale) };
+    }
+    Point_2 toWorld(const IPoint& p) const {
+        return { static_cast<double>(p.x) / scale + centerX, static_cast<double>(p.y) / scale + centerY };
+    }
+};
+
+/**
+ * @brief Строит сырую эквидистанту одного контура на сетке.
+ * @param path Контур на сетке (материал слева, без повторов точек).
+ * @param delta Смещение в единицах сетки.
+ */
+void rawOffset(const IPath& path, double delta, const OffsetOptions& options, double arcTolerance, IPath& out) {
+    out.clear();
+    std::size_t n = path.size();
+    double radius = std::abs(delta);
+
+    // Ребро i идёт из вершины i в i + 1; нормаль - внешняя (справа от ребра).
+    struct EdgeFrame {
+        double nx, ny, length;
+    };
+    std::vector<EdgeFrame> frames(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const IPoint& a = path[i];
+        const IPoint& b = path[(i + 1) % n];
+        double dx = static_cast<double>(b.x - a.x), dy = static_cast<double>(b.y - a.y);
+        double length = std::hypot(dx, dy);
+        frames[i] = { dy / length, -dx / length, length };
+    }
+
+    // Вогнутый для сдвига угол укорачивает оба ребра на radius * tg(угла / 2).
+    std::vector<double> overlap(n, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        const EdgeFrame& e1 = frames[(i + n - 1) % n];
+        const EdgeFrame& e2 = frames[i];
+        double sine = e1.nx * e2.ny - e1.ny * e2.nx;
+        double cosine = e1.nx * e2.nx + e1.ny * e2.ny;
+        if (sine * delta < 0) overlap[i] = cosine > -0.99 ? radius * std::abs(sine) / (1 + cosine) : HUGE_VAL;
+    }
+
+    auto push = [&](double x, double y) {
+        IPoint p{ std::llround(x), std::llround(y) };
+        if (out.empty() || !(out.back() == p)) out.push_back(p);
+    };
+
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t prev = (i + n - 1) % n;
+        const EdgeFrame& e1 = frames[prev];
+        const EdgeFrame& e2 = frames[i];
+        double n1x = e1.nx, n1y = e1.ny, n2x = e2.nx, n2y = e2.ny;
+        double cx = static_cast<double>(path[i].x), cy = static_cast<double>(path[i].y);
+
+        double sine = n1x * n2y - n1y * n2x;
+        double cosine = n1x * n2x + n1y * n2y;
+
+        if (std::abs(sine) < 1e-12 && cosine > 0) {
+            push(cx + n1x * delta, cy + n1y * delta);
+            continue;
+        }
+
+        if (sine * delta <= 0) {
+            // Угол вогнутый для направления сдвига. Если оба ребра остаются длиннее
+            // укорочений с обоих концов, сдвинутые рёбра пересекаются в точке острия -
+            // её и берём. Иначе - петля через вершину, которая снимется на шаге
+            // классификации (так же снимаются и вывернутые рёбра при большом сдвиге).
+            if (overlap[prev] + overlap[i] < e1.length && overlap[i] + overlap[(i + 1) % n] < e2.length) {
+                push(cx + (n1x + n2x) * delta / (1 + cosine), cy + (n1y + n2y) * delta / (1 + cosine));
+                continue;
+            }
+            push(cx + n1x * delta, cy + n1y * delta);
+            push(cx, cy);
+            push(cx + n2x * delta, cy + n2y * delta);
+            continue;
+        }
+
+        if (options.join == JoinType::Miter) {
+            double q = 1 + cosine;
+            if (q > 2 / (options.miterLimit * options.miterLimit)) {
+                push(cx + (n1x + n2x) * delta / q, cy + (n1y + n2y) * delta / q);
+            }
+            else {
+                push(cx + n1x * delta, cy + n1y * delta);
+                push(cx + n2x * delta, cy + n2y * delta);
+            }
+            continue;
+        }
+
+        // Скругление: дуга от n1 к n2 с шагом по допуску хорды.
+        double sweep = std::atan2(sine, cosine);
+        double stepAngle = radius > arcTolerance ? 2 * std::acos(1 - arcTolerance / radius) : std::numbers::pi / 2;
+        int steps = std::clamp(static_cast<int>(std::ceil(std::abs(sweep) / stepAngle)), 1, MAX_ARC_STEPS);
+        double sn = std::sin(sweep / steps), cs = std::cos(sweep / steps);
+        double vx = n1x, vy = n1y;
+        push(cx + vx * delta, cy + vy * delta);
+        for (int k = 1; k < steps; ++k) {
+            double rx = vx * cs - vy * sn;
+            vy = vx * sn + vy * cs;
+            vx = rx;
+            push(cx + vx * delta, cy + vy * delta);
+        }
+        push(cx + n2x * delta, cy + n2y * delta);
+    }
+
+    while (out.size() > 1 && out.back() == out.front()) out.pop_back();
+}
+
+/**
+ * @brief Равномерная сетка ячеек над рёбрами для поиска пар-кандидатов.
+ */
+class CellGrid {
+public:
+    CellGrid(const std::vector<IEdge>& edges) {
+        low_ = high_ = edges.front().a;
+        for (const auto& e : edges) {
+            for (const IPoint& p : { e.a, e.b }) {
+                low_ = { std::min(low_.x, p.x), std::min(low_.y, p.y) };
+                high_ = { std::max(high_.x, p.x), std::max(high_.y, p.y) };
+            }
+        }
+        side_ = std::max<std::size_t>(1, static_cast<std::size_t>(std::sqrt(static_cast<double>(edges.size()))));
+        double extent = static_cast<double>(std::max(high_.x - low_.x, high_.y - low_.y)) + 1;
+        cellSize_ = std::max(1.0, extent / static_cast<double>(side_));
+
+        std::vector<std::size_t> counts(side_ * side_ + 1, 0);
+        for (const auto& e : edges) forEachCell(e, [&](std::size_t c) { ++counts[c + 1]; });
+        for (std::size_t c = 1; c < counts.size(); ++c) counts[c] += counts[c - 1];
+        offsets_ = counts;
+        items_.resize(counts.back());
+        for (std::size_t i = 0; i < edges.size(); ++i)
+            forEachCell(edges[i], [&](std::size_t c) { items_[counts[c]++] = i; });
+    }
+
+    std::size_t cellCount() const { return side_ * side_; }
+    std::size_t cellOf(std::size_t cx, std::size_t cy) const { return cy * side_ + cx; }
+
+    /// Ячейки рамки ребра: [x0, x1] x [y0, y1].
+    void range(const IEdge& e, std::size_t& x0, std::size_t& y0, std::size_t& x1, std::size_t& y1) const {
+        x0 = coord(std::min(e.a.x, e.b.x) - low_.x);
+        x1 = coord(std::max(e.a.x, e.b.x) - low_.x);
+        y0 = coord(std::min(e.a.y, e.b.y) - low_.y);
+        y1 = coord(std::max(e.a.y, e.b.y) - low_.y);
+    }
+
+    const std::size_t* begin(std::size_t cell) const { return items_.data() + offsets_[cell]; }
+    const std::size_t* end(std::size_t cell) const { return items_.data() + offsets_[cell + 1]; }
+
+private:
+    std::size_t coord(std::int64_t delta) const {
+        auto c = static_cast<std::size_t>(static_cast<double>(delta) / cellSize_);
+        return std::min(c, side_ - 1);
+    }
+
+    template <typename F>
+    void forEachCell(const IEdge& e, F&& f) const {
+        std::size_t x0, y0, x1, y1;
+        range(e, x0, y0, x1, y1);
+        for (std::size_t y = y0; y <= y1; ++y)
+            for (std::size_t x = x0; x <= x1; ++x) f(cellOf(x, y));
+    }
+
+    IPoint low_, high_;
+    std::size_t side_ = 1;
+    double cellSize_ = 1;
+    std::vector<std::size_t> offsets_;
+    std::vector<std::size_t> items_;
+};
+
+/// Лежит ли p строго внутри отрезка ab (с учётом коллинеарности).
+bool strictlyInside(const IPoint& a, const IPoint& b, const IPoint& p) {
+    if (p == a || p == b) return false;
+    return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) &&
+           std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+}
+
+struct Split {
+    std::size_t edge;
+    IPoint point;
+};
+
+/**
+ * @brief Находит точки, в которых рёбра надо разрезать.
+ */
+std::size_t findSplits(const std::vector<IEdge>& edges, std::vector<Split>& splits) {
+    CellGrid grid(edges);
+    std::size_t intersections = 0;
+
+    auto test = [&](std::size_t i, std::size_t j) {
+        const IEdge& e = edges[i];
+        const IEdge& f = edges[j];
+        int o1 = sign(cross(e.a, e.b, f.a));
+        int o2 = sign(cross(e.a, e.b, f.b));
+        int o3 = sign(cross(f.a, f.b, e.a));
+        int o4 = sign(cross(f.a, f.b, e.b));
+
+        if (o1 * o2 < 0 && o3 * o4 < 0) {
+            // Собственное пересечение: точка округляется на сетку.
+            double ex = static_cast<double>(e.b.x - e.a.x), ey = static_cast<double>(e.b.y - e.a.y);
+            double fx = static_cast<double>(f.b.x - f.a.x), fy = static_cast<double>(f.b.y - f.a.y);
+            double t = static_cast<double>(cross(f.a, f.b, e.a)) / (ex * fy - ey * fx);
+            IPoint p{ std::llround(static_cast<double>(e.a.x) + t * ex), std::llround(static_cast<double>(e.a.y) + t * ey) };
+            if (!(p == e.a) && !(p == e.b)) splits.push_back({ i, p });
+            if (!(p == f.a) && !(p == f.b)) splits.push_back({ j, p });
+            ++intersections;
+            return;
+        }
+
+        // Касания и коллинеарные перекрытия: конец одного ребра внутри другого.
+        if (o1 == 0 && strictlyInside(e.a, e.b, f.a)) { splits.push_back({ i, f.a }); ++intersections; }
+        if (o2 == 0 && strictlyInside(e.a, e.b, f.b)) { splits.push_back({ i, f.b }); ++intersections; }
+        if (o3 == 0 && strictlyInside(f.a, f.b, e.a)) { splits.push_back({ j, e.a }); ++intersections; }
+        if (o4 == 0 && strictlyInside(f.a, f.b, e.b)) { splits.push_back({ j, e.b }); ++intersections; }
+    };
+
+    std::vector<std::size_t> lows(edges.size() * 2);
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        std::size_t x0, y0, x1, y1;
+        grid.range(edges[i], x0, y0, x1, y1);
+        lows[2 * i] = x0;
+        lows[2 * i + 1] = y0;
+    }
+
+    for (std::size_t cell = 0; cell < grid.cellCount(); ++cell) {
+        const std::size_t* first = grid.begin(cell);
+        const std::size_t* last = grid.end(cell);
+        for (const std::size_t* p = first; p != last; ++p) {
+            for (const std::size_t* q = p + 1; q != last; ++q) {
+                // Пара проверяется только в первой общей ячейке своих рамок.
+                std::size_t x = std::max(lows[2 * *p], lows[2 * *q]);
+                std::size_t y = std::max(lows[2 * *p + 1], lows[2 * *q + 1]);
+                if (grid.cellOf(x, y) != cell) continue;
+                test(*p, *q);
+            }
+        }
+    }
+    return intersections;
+}
+
+/**
+ * @brief Сетка ячеек для подсчёта числа обхода лучом +x.
+ *
+ * Все координаты удвоены, чтобы середины кусков были целыми. Границы столбцов
+ * и средние линии строк лежат на нечётных (в удвоенных единицах) значениях
+ * и поэтому не проходят через вершины. Для каждой ячейки заранее известно
+ * число обхода в точке (правая граница, средняя линия строки); запрос
+ * досчитывает его только по рёбрам своей ячейки: пересечения правой границы
+ * между средней линией и точкой и пересечения луча внутри ячейки. Все
+ * сравнения точные в int64.
+ */
+class WindingGrid {
+public:
+    explicit WindingGrid(const std::vector<IEdge>& edges) : edges_(edges) {
+        if (edges_.empty()) return;
+        IPoint low = edges_.front().a, high = low;
+        for (const auto& e : edges_) {
+            for (const IPoint& p : { e.a, e.b }) {
+                low = { std::min(low.x, p.x), std::min(low.y, p.y) };
+                high = { std::max(high.x, p.x), std::max(high.y, p.y) };
+            }
+        }
+
+        // Около двух рёбер на ячейку; сторона ячейки - чётное целое.
+        double extent = static_cast<double>(std::max(high.x - low.x, high.y - low.y)) + 2;
+        double side = std::max(1.0, std::sqrt(static_cast<double>(edges_.size()) / 2));
+        cell2_ = 4 * std::max<std::int64_t>(1, static_cast<std::int64_t>(std::ceil(extent / side / 2)));
+        left2_ = 2 * low.x - 1;
+        bottom2_ = 2 * low.y - 1;
+        columns_ = static_cast<std::size_t>((2 * high.x - left2_) / cell2_ + 1);
+        rows_ = static_cast<std::size_t>((2 * high.y - bottom2_) / cell2_ + 1);
+
+        std::vector<std::size_t> counts(rows_ * columns_ + 1, 0);
+        for (const auto& e : edges_) forEachCell(e, [&](std::size_t c) { ++counts[c + 1]; });
+        for (std::size_t c = 1; c < counts.size(); ++c) counts[c] += counts[c - 1];
+        offsets_ = counts;
+        items_.resize(counts.back());
+        for (std::size_t i = 0; i < edges_.size(); ++i)
+            forEachCell(edges_[i], [&](std::size_t c) { items_[counts[c]++] = i; });
+
+        // Число обхода на правых границах ячеек по средним линиям строк (через разностный массив).
+        base_.assign(rows_ * columns_ + rows_, 0);
+        for (const auto& e : edges_) {
+            if (e.a.y == e.b.y) continue;
+            int s = e.b.y > e.a.y ? 1 : -1;
+            std::int64_t y0 = 2 * std::min(e.a.y, e.b.y), y1 = 2 * std::max(e.a.y, e.b.y);
+            for (std::size_t r = row(y0); r < rows_ && middle2(r) < y1; ++r) {
+                std::int64_t yc = middle2(r);
+                if (yc < y0) continue;
+                // Число правых границ левее точки пересечения.
+                std::size_t j = column(2 * std::min(e.a.x, e.b.x));
+                while (j < columns_ && rightOf(e, boundary2(j + 1), yc)) ++j;
+                base_[r * (columns_ + 1)] += s;
+                base_[r * (columns_ + 1) + j] -= s;
+            }
+        }
+        for (std::size_t r = 0; r < rows_; ++r) {
+            int* line = base_.data() + r * (columns_ + 1);
+            for (std::size_t c = 1; c < columns_; ++c) line[c] += line[c - 1];
+        }
+    }
+
+    /**
+     * @brief Число обхода в точке (x2/2, y2/2) без рёбер, проходящих через неё.
+     * @param up Рёбра через точку, направленные вверх.
+     * @param down Рёбра через точку, направленные вниз.
+     */
+    int winding(std::int64_t x2, std::int64_t y2, int& up, int& down) const {
+        up = down = 0;
+        if (edges_.empty()) return 0;
+        std::size_t c = column(x2), r = row(y2);
+        std::int64_t boundary = boundary2(c + 1);
+        std::int64_t yc = middle2(r);
+        int w = base_[r * (columns_ + 1) + c];
+
+        std::size_t cell = r * columns_ + c;
+        for (std::size_t k = offsets_[cell]; k < offsets_[cell + 1]; ++k) {
+            const IEdge& e = edges_[items_[k]];
+
+            // Переход от средней линии к точке вдоль правой границы.
+            if (2 * std::min(e.a.x, e.b.x) < boundary && boundary < 2 * std::max(e.a.x, e.b.x))
+                w += crossingContribution(e, crossingSide(e, boundary, y2)) -
+                     crossingContribution(e, crossingSide(e, boundary, yc));
+
+            if (e.a.y == e.b.y) continue;
+            int s = e.b.y > e.a.y ? 1 : -1;
+
+            // Пересечения луча внутри ячейки: правее точки, но не правее границы.
+            bool inRange = s > 0 ? 2 * e.a.y <= y2 && y2 < 2 * e.b.y : 2 * e.b.y <= y2 && y2 < 2 * e.a.y;
+            if (!inRange) continue;
+            std::int64_t side = s * sideOf(e, x2, y2);
+            if (side == 0) {
+                if (s > 0) ++up;
+                else ++down;
+            }
+            else if (side > 0 && s * sideOf(e, boundary, y2) <= 0) {
+                w += s;
+            }
+        }
+        return w;
+    }
+
+private:
+    /// Положение удвоенной точки относительно прямой ребра (> 0 - слева).
+    static std::int64_t sideOf(const IEdge& e, std::int64_t x2, std::int64_t y2) {
+        return (e.b.x - e.a.x) * (y2 - 2 * e.a.y) - (x2 - 2 * e.a.x) * (e.b.y - e.a.y);
+    }
+
+    /// Знак (y2 - y*), где y* - высота пересечения ребра с вертикалью x2.
+    static std::int64_t crossingSide(const IEdge& e, std::int64_t x2, std::int64_t y2) {
+        std::int64_t side = sideOf(e, x2, y2);
+        return e.b.x > e.a.x ? side : -side;
+    }
+
+    /**
+     * @brief Вклад ребра, пересекающего вертикаль, в число обхода точки на ней.
+     * @param sigma Знак (y - y*) для точки.
+     *
+     * Наклонное ребро считается лучом, пока пересекает горизонталь точки правее
+     * вертикали. Горизонтальное ребро само луч не пересекает, но переносит
+     * вдоль вертикали вклад соседних рёбер; по полуоткрытому правилу на своей
+     * высоте оно уже учтено.
+     */
+    static int crossingContribution(const IEdge& e, std::int64_t sigma) {
+        int sx = e.b.x > e.a.x ? 1 : -1;
+        if (e.a.y == e.b.y) return sigma >= 0 ? sx : 0;
+        int sy = e.b.y > e.a.y ? 1 : -1;
+        return sigma * sx * sy > 0 ? sy : 0;
+    }
+
+    /// Пересекает ли прямая ребра горизонталь y2 строго правее x2.
+    static bool rightOf(const IEdge& e, std::int64_t x2, std::int64_t y2) {
+        std::int64_t side = sideOf(e, x2, y2);
+        return e.b.y > e.a.y ? side > 0 : side < 0;
+    }
+
+    std::int64_t boundary2(std::size_t c) const { return left2_ + static_cast<std::int64_t>(c) * cell2_; }
+    std::int64_t middle2(std::size_t r) const { return bottom2_ + static_cast<std::int64_t>(r) * cell2_ + cell2_ / 2; }
+
+    std::size_t column(std::int64_t x2) const {
+        auto c = static_cast<std::size_t>(std::max<std::int64_t>(0, (x2 - left2_) / cell2_));
+        return std::min(c, columns_ - 1);
+    }
+    std::size_t row(std::int64_t y2) const {
+        auto r = static_cast<std::size_t>(std::max<std::int64_t>(0, (y2 - bottom2_) / cell2_));
+        return std::min(r, rows_ - 1);
+    }
+
+    template <typename F>
+    void forEachCell(const IEdge& e, F&& f) const {
+        std::size_t c0 = column(2 * std::min(e.a.x, e.b.x)), c1 = column(2 * std::max(e.a.x, e.b.x));
+        std::size_t r0 = row(2 * std::min(e.a.y, e.b.y)), r1 = row(2 * std::max(e.a.y, e.b.y));
+        for (std::size_t r = r0; r <= r1; ++r)
+            for (std::size_t c = c0; c <= c1; ++c) f(r * columns_ + c);
+    }
+
+    const std::vector<IEdge>& edges_;
+    std::int64_t left2_ = 0, bottom2_ = 0, cell2_ = 4;
+    std::size_t columns_ = 1, rows_ = 1;
+    std::vector<std::size_t> offsets_;
+    std::vector<std::size_t> items_;
+    /// Число обхода на правой границе ячейки по средней линии строки; строка - columns_ + 1 значений.
+    std::vector<int> base_;
+};
+
+/// Поворот на -90°: горизонтальные рёбра становятся вертикальными.
+IPoint rotate(const IPoint& p) {
+    return { p.y, -p.x };
+}
+
+/// Удаляет вершины, лежащие на прямой между соседями.
+void removeCollinear(IPath& path) {
+    bool changed = true;
+    while (changed && path.size() >= 3) {
+        changed = false;
+        IPath kept;
+        kept.reserve(path.size());
+        std::size_t n = path.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            const IPoint& prev = kept.empty() ? path[n - 1] : kept.back();
+            const IPoint& next = path[(i + 1) % n];
+            if (cross(prev, path[i], next) == 0) {
+                changed = true;
+                continue;
+            }
+            kept.push_back(path[i]);
+        }
+        path.swap(kept);
+    }
+}
+
+/// Правило заполнения при выделении границы.
+enum class FillRule { EvenOdd, Positive };
+
+/**
+ * @brief Режет рёбра в точках пересечения и оставляет куски границы области.
+ *
+ * Для каждого куска считается число обхода слева и справа от него (лучом +x
+ * из середины; горизонтальные куски - в повёрнутых координатах). Кусок
+ * остаётся, если по разные стороны от него заполнение разное, и ориентируется
+ * так, чтобы область была слева. Совпадающие куски выдаются один раз.
+ */
+std::vector<IEdge> boundaryEdges(const std::vector<IEdge>& edges, FillRule rule, OffsetStats& stats) {
+    std::vector<Split> splits;
+    stats.intersections += findSplits(edges, splits);
+    std::sort(splits.begin(), splits.end(), [&](const Split& s, const Split& t) {
+        if (s.edge != t.edge) return s.edge < t.edge;
+        const IEdge& e = edges[s.edge];
+        std::int64_t dx = e.b.x - e.a.x, dy = e.b.y - e.a.y;
+        return (s.point.x - e.a.x) * dx + (s.point.y - e.a.y) * dy <
+               (t.point.x - e.a.x) * dx + (t.point.y - e.a.y) * dy;
+    });
+
+    std::vector<IEdge> pieces;
+    pieces.reserve(edges.size() + splits.size());
+    std::size_t s = 0;
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        IPoint from = edges[i].a;
+        for (; s < splits.size() && splits[s].edge == i; ++s) {
+            if (splits[s].point == from) continue;
+            pieces.push_back({ from, splits[s].point });
+            from = splits[s].point;
+        }
+        if (!(from == edges[i].b)) pieces.push_back({ from, edges[i].b });
+    }
+    stats.pieces += pieces.size();
+
+    std::vector<IEdge> rotatedPieces(pieces.size());
+    for (std::size_t i = 0; i < pieces.size(); ++i)
+        rotatedPieces[i] = { rotate(pieces[i].a), rotate(pieces[i].b) };
+    WindingGrid byY(pieces);
+    WindingGrid byX(rotatedPieces);
+
+    auto filled = [rule](int winding) {
+        return rule == FillRule::EvenOdd ? (winding & 1) != 0 : winding > 0;
+    };
+
+    std::vector<IEdge> boundary;
+    std::set<std::array<std::int64_t, 4>> emitted;
+    for (const auto& piece : pieces) {
+        bool horizontal = piece.a.y == piece.b.y;
+        IEdge e = horizontal ? IEdge{ rotate(piece.a), rotate(piece.b) } : piece;
+        const WindingGrid& index = horizontal ? byX : byY;
+
+        int up = 0, down = 0;
+        int w = index.winding(e.a.x + e.b.x, e.a.y + e.b.y, up, down);
+        // Совпадающие с куском рёбра (включая его самого) меняют число обхода только слева от вертикали.
+        bool upward = e.a.y < e.b.y;
+        bool left = filled(upward ? w + up - down : w);
+        bool right = filled(upward ? w : w + up - down);
+        if (left == right) continue;
+
+        IEdge oriented = left ? piece : IEdge{ piece.b, piece.a };
+        if (up + down > 1 && !emitted.insert({ oriented.a.x, oriented.a.y, oriented.b.x, oriented.b.y }).second)
+            continue;
+        boundary.push_back(oriented);
+    }
+    return boundary;
+}
+
+/**
+ * @brief Сшивает ориентированные куски в замкнутые контуры.
+ */
+void linkLoops(const std::vector<IEdge>& boundary, std::vector<IPath>& loops) {
+    // Куски одного исходного контура идут подряд, поэтому продолжение сначала
+    // ищется у следующего куска, а отсортированный список начал нужен только на стыках.
+    std::vector<std::pair<IPoint, std::size_t>> starts(boundary.size());
+    for (std::size_t i = 0; i < boundary.size(); ++i) starts[i] = { boundary[i].a, i };
+    auto less = [](const IPoint& p, const IPoint& q) { return p.x != q.x ? p.x < q.x : p.y < q.y; };
+    std::sort(starts.begin(), starts.end(), [&](const auto& s, const auto& t) { return less(s.first, t.first); });
+
+    std::vector<bool> used(boundary.size(), false);
+    IPath path;
+    for (std::size_t start = 0; start < boundary.size(); ++start) {
+        if (used[start]) continue;
+        path.clear();
+        std::size_t current = start;
+        while (!used[current]) {
+            used[current] = true;
+            path.push_back(boundary[current].a);
+            const IPoint& end = boundary[current].b;
+            std::size_t next = current;
+            if (current + 1 < boundary.size() && !used[current + 1] && boundary[current + 1].a == end) {
+                next = current + 1;
+            }
+            else {
+                auto it = std::lower_bound(starts.begin(), starts.end(), end,
+                    [&](const auto& s, const IPoint& p) { return less(s.first, p); });
+                for (; it != starts.end() && it->first == end; ++it) {
+                    if (!used[it->second]) {
+                        next = it->second;
+                        break;
+                    }
+                }
+            }
+            if (next == current) break;
+            current = next;
+        }
+
+        removeCollinear(path);
+        // Петли площадью в несколько клеток сетки - шум округления.
+        if (path.size() < 3 || std::abs(signedArea2(path)) <= 8) continue;
+        loops.push_back(path);
+    }
+}
+
+void appendEdges(const IPath& path, std::vector<IEdge>& edges) {
+    for (std::size_t i = 0; i < path.size(); ++i) {
+        IEdge e{ path[i], path[(i + 1) % path.size()] };
+        if (!(e.a == e.b)) edges.push_back(e);
+    }
+}
+
+} // namespace
+
+Contours offsetContours(const Contours& contours, double delta, const OffsetOptions& options,
+    OffsetStats* stats, std::pmr::memory_resource* resource) {
+    Contours result(resource);
+    OffsetStats local;
+    if (!stats) stats = &local;
+    *stats = {};
+
+    Contours input(resource);
+    for (const auto& contour : contours) {
+        if (contour.size() >= 3) input.push_back(contour);
+    }
+    Point_2 low, high;
+    if (input.empty() || !computeBounds(input, low, high)) return result;
+
+    // Масштаб - степень двойки, центр - узел сетки: точки на сетке переводятся туда и обратно без потерь.
+    double halfExtent = std::max(high.x - low.x, high.y - low.y) / 2 + 2 * std::abs(delta);
+    if (!(halfExtent > 0)) return result;
+    GridTransform grid;
+    grid.scale = std::exp2(std::floor(std::log2(GRID_HALF_EXTENT / halfExtent)));
+    grid.centerX = std::round((low.x + high.x) / 2 * grid.scale) / grid.scale;
+    grid.centerY = std::round((low.y + high.y) / 2 * grid.scale) / grid.scale;
+
+    double gridDelta = delta * grid.scale;
+    double arcTolerance = (options.arcTolerance > 0 ? options.arcTolerance : std::abs(delta) * 0.01) * grid.scale;
+    arcTolerance = std::max(arcTolerance, 0.25);
+
+    // 1-2. Перевод на сетку и нормализация по правилу чётности: самопересечения
+    // и перекрытия снимаются, внешние контуры получают обход против часовой стрелки.
+    std::vector<IEdge> edges;
+    IPath path;
+    for (const auto& contour : input) {
+        path.clear();
+        for (const auto& p : contour) {
+            IPoint q = grid.toGrid(p);
+            if (path.empty() || !(path.back() == q)) path.push_back(q);
+        }
+        while (path.size() > 1 && path.back() == path.front()) path.pop_back();
+        if (path.size() >= 3) appendEdges(path, edges);
+    }
+    if (edges.empty()) return result;
+
+    OffsetStats normalizeStats;
+    std::vector<IPath> loops;
+    linkLoops(boundaryEdges(edges, FillRule::EvenOdd, normalizeStats), loops);
+
+    // 3. Сырая эквидистанта.
+    edges.clear();
+    IPath raw;
+    for (const auto& loop : loops) {
+        rawOffset(loop, gridDelta, options, arcTolerance, raw);
+        appendEdges(raw, edges);
+    }
+    stats->rawEdges = edges.size();
+    if (edges.empty()) return result;
+
+    // 4-5. Разрезание, отбор кусков с положительным числом обхода, сшивание.
+    loops.clear();
+    linkLoops(boundaryEdges(edges, FillRule::Positive, *stats), loops);
+
+    for (const auto& loop : loops) {
+        Contour contour(resource);
+        contour.reserve(loop.size());
+        for (const auto& p : loop) contour.push_back(grid.toWorld(p));
+        result.push_back(std::move(contour));
+    }
+    stats->contours = result.size();
+    return result;
+}
@@ -0,0 +1,74 @@
+﻿/**
+ * @file offset.h
+ * @brief Эквидистанта (inset/outset) контуров на целочисленной сетке.
+ *
+ * Лазерная и фрезерная штриховка должна отступать от контура на радиус пятна
+ * или инструмента. Алгоритм устроен как в Clipper:
+ *
+ * 1. Координаты переводятся на целочисленную сетку; все предикаты
+ *    (ориентация, пересечение) на ней точные.
+ * 2. Контуры нормализуются по правилу чётности тем же разрезанием и отбором
+ *    кусков, что и в п. 4: самопересечения и перекрытия снимаются, внешние
+ *    контуры обходятся против часовой стрелки, дыры - по часовой, так что
+ *    материал всегда слева от ребра.
+ * 3. Строится "сырая" эквидистанта: рёбра сдвигаются по нормали, на выпуклых
+ *    для сдвига углах добавляется скругление или острие, на вогнутых - петля
+ *    через исходную вершину.
+ * 4. Сырые рёбра режутся во всех точках взаимного пересечения (поиск пар
+ *    через равномерную сетку ячеек), для каждого куска считается число
+ *    обхода по обе стороны, и остаются только куски границы области
+ *    с положительным числом обхода. Так снимаются петли на вогнутых углах
+ *    и слияния соседних контуров.
+ * 5. Оставшиеся куски сшиваются в замкнутые контуры.
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <memory_resource>
+
+/**
+ * @brief Обработка выпуклых (для направления сдвига) углов.
+ *
+ * Miter при превышении miterLimit переходит в срез угла (bevel).
+ */
+enum class JoinType { Round, Miter };
+
+/**
+ * @brief Параметры построения эквидистанты.
+ */
+struct OffsetOptions {
+    /// Тип соединения на углах.
+    JoinType join = JoinType::Round;
+    /// Предельная длина острия (в долях |delta|) для JoinType::Miter; длиннее - срез.
+    double miterLimit = 2.0;
+    /// Отклонение хорды скругления от дуги; 0 - 1% от |delta|.
+    double arcTolerance = 0;
+};
+
+/**
+ * @brief Счётчики последнего построения.
+ */
+struct OffsetStats {
+    /// Рёбер сырой эквидистанты.
+    std::size_t rawEdges = 0;
+    /// Найденных точек пересечения сырых рёбер.
+    std::size_t intersections = 0;
+    /// Кусков рёбер после разрезания.
+    std::size_t pieces = 0;
+    /// Контуров результата.
+    std::size_t contours = 0;
+};
+
+/**
+ * @brief Строит эквидистанту области, заданной контурами (правило чётности).
+ * @param contours Исходные контуры.
+ * @param delta Смещение: > 0 - наружу (outset), < 0 - внутрь (inset).
+ * @param options Параметры углов.
+ * @param stats Счётчики (необязательно).
+ * @param resource Источник памяти для результата.
+ * @return Контуры результата: внешние против часовой стрелки, дыры - по часовой.
+ */
+Contours offsetContours(const Contours& contours, double delta, const OffsetOptions& options = {},
+    OffsetStats* stats = nullptr, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
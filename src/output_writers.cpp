@@ -0,0 +1,97 @@
+﻿/**
+ * @file output_writers.cpp
+ * @brief Реализация записи SVG и двоичного формата.
+ */
+
+#include "output_writers.h"
+#include "transform_kernel.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+/// Умножает координаты точек буфера на масштаб (векторным проходом по x и по y).
+void scalePoints(PointArrays& points, double scale) {
+    scaleValues(points.x.data(), points.x.data(), points.size(), scale);
+    scaleValues(points.y.data(), points.y.data(), points.size(), scale);
+}
+
+/// Копирует точки ломаной или контура в буфер и масштабирует их.
+const PointArrays& scaled(const std::pmr::vector<Point_2>& source, double scale, PointArrays& buffer) {
+    buffer.clear();
+    for (const Point_2& p : source) buffer.push_back(p.x, p.y);
+    scalePoints(buffer, scale);
+    return buffer;
+}
+
+} // namespace
+
+void writeSvg(std::ostream& out, const Polylines& perimeters, const Lines& lines, const Contours& contours,
+    double scale) {
+    Point_2 bottomLeft{};
+    Point_2 topRight{};
+    computeBounds(contours, bottomLeft, topRight);
+
+    double svgWidth = std::max(300.0, topRight.x * scale);
+    double svgHeight = std::max(200.0, topRight.y * scale);
+    out << "<svg xmlns='http://www.w3.org/2000/svg' width='" << svgWidth
+        << "' height='" << svgHeight << "'>\n";
+
+    // Масштаб применяется ко всем координатам одним векторным проходом до вывода.
+    PointArrays buffer;
+    for (const auto& polyline : perimeters) {
+        const auto& p = scaled(polyline, scale, buffer);
+        out << "<polyline points='";
+        for (std::size_t i = 0; i < p.size(); ++i)
+            out << (i ? " " : "") << p.x[i] << "," << p.y[i];
+        out << "' fill='none' stroke='blue' stroke-width='0.5'/>\n";
+    }
+
+    // Концы линий: начало и конец подряд.
+    buffer.clear();
+    for (const auto& line : lines) {
+        buffer.push_back(line.start.x, line.start.y);
+        buffer.push_back(line.end.x, line.end.y);
+    }
+    scalePoints(buffer, scale);
+    for (std::size_t i = 0; i + 1 < buffer.size(); i += 2) {
+        out << "<line x1='" << buffer.x[i]
+            << "' y1='" << buffer.y[i]
+            << "' x2='" << buffer.x[i + 1]
+            << "' y2='" << buffer.y[i + 1]
+            << "' stroke='black' stroke-width='0.5'/>\n";
+    }
+
+    // Рисуем контуры
+    for (const auto& contour : contours) {
+        const auto& p = scaled(contour, scale, buffer);
+        for (std::size_t i = 0; i < p.size(); ++i) {
+            std::size_t j = (i + 1) % p.size();
+
+            out << "<line x1='" << p.x[i]
+                << "' y1='" << p.y[i]
+                << "' x2='" << p.x[j]
+                << "' y2='" << p.y[j]
+                << "' stroke='red' stroke-width='1'/>\n";
+        }
+    }
+
+    out << "</svg>";
+}
+
+void writeBinary(std::ostream& out, const Lines& lines, const Polylines& perimeters) {
+    std::uint64_t count = lines.size();
+    out.write(reinterpret_cast<const char*>(&count), sizeof count);
+    out.write(reinterpret_cast<const char*>(lines.data()), static_cast<std::streamsize>(count * sizeof(Line_2)));
+    if (perimeters.empty()) return;
+
+    count = perimeters.size();
+    out.write(reinterpret_cast<const char*>(&count), sizeof count);
+    for (const auto& polyline : perimeters) {
+        count = polyline.size();
+        out.write(reinterpret_cast<const char*>(&count), sizeof count);
+        out.write(reinterpret_cast<const char*>(polyline.data()),
+            static_cast<std::streamsize>(count * sizeof(Point_2)));
+    }
+}
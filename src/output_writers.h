@@ -0,0 +1,51 @@
+﻿/**
+ * @file output_writers.h
+ * @brief Запись результата штриховки в поддерживаемые форматы.
+ *
+ * - SVG: ломаные (периметры и узоры заполнения) синим, линии штриховки
+ *   чёрным, контуры красным (для просмотра); элементы идут в порядке прохода.
+ * - двоичный: число линий (uint64) и координаты линий (double), для станков
+ *   и для ответов сервера. Если есть ломаные (периметры, узоры
+ *   заполнения), за линиями следует их блок: число ломаных (uint64), для
+ *   каждой число точек (uint64) и точки (пары double). Ломаные выполняются до штриховки; без них формат не меняется.
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <ostream>
+
+/**
+ * @brief Формат вывода результата.
+ */
+enum class OutputFormat : unsigned char { Binary = 0, Svg = 1 };
+
+/// Масштаб координат в SVG по умолчанию.
+constexpr double SVG_SCALE = 10.0;
+
+/**
+ * @brief Записывает периметры, штриховку и контуры в SVG.
+ * @param out Выходной поток.
+ * @param perimeters Ломаные периметров.
+ * @param lines Линии штриховки.
+ * @param contours Контуры (рисуются поверх штриховки).
+ * @param scale Масштаб координат.
+ */
+void writeSvg(std::ostream& out, const Polylines& perimeters, const Lines& lines, const Contours& contours,
+    double scale = SVG_SCALE);
+
+/**
+ * @brief Записывает штриховку и контуры в SVG (без периметров).
+ */
+inline void writeSvg(std::ostream& out, const Lines& lines, const Contours& contours, double scale = SVG_SCALE) {
+    writeSvg(out, Polylines{}, lines, contours, scale);
+}
+
+/**
+ * @brief Записывает линии и периметры в двоичном формате.
+ * @param out Выходной поток (двоичный режим).
+ * @param lines Линии штриховки.
+ * @param perimeters Ломаные периметров (блок пишется, только если они есть).
+ */
+void writeBinary(std::ostream& out, const Lines& lines, const Polylines& perimeters = {});
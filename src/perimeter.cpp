@@ -0,0 +1,100 @@
+﻿/**
+ * @file perimeter.cpp
+ * @brief Реализация построения периметров.
+ */
+
+#include "perimeter.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+double distanceSquared(const Point_2& a, const Point_2& b) {
+    double dx = a.x - b.x, dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+/// Переносит точки контура в ломаную, начиная с вершины start, и замыкает её.
+void appendLoop(const Contour& contour, std::size_t start, Polyline& out) {
+    out.reserve(contour.size() + 1);
+    for (std::size_t i = 0; i < contour.size(); ++i) out.push_back(contour[(start + i) % contour.size()]);
+    out.push_back(contour[start]);
+}
+
+} // namespace
+
+void orderLoops(Polylines& loops, Point_2& position) {
+    // Рамки ломаных отсекают те, что заведомо дальше уже найденной вершины.
+    std::vector<std::pair<Point_2, Point_2>> boxes(loops.size());
+    for (std::size_t i = 0; i < loops.size(); ++i) {
+        if (loops[i].empty()) continue;
+        auto& [low, high] = boxes[i];
+        low = high = loops[i].front();
+        for (const auto& p : loops[i]) {
+            low = { std::min(low.x, p.x), std::min(low.y, p.y) };
+            high = { std::max(high.x, p.x), std::max(high.y, p.y) };
+        }
+    }
+
+    for (std::size_t done = 0; done < loops.size(); ++done) {
+        std::size_t bestLoop = done;
+        std::size_t bestVertex = 0;
+        double best = std::numeric_limits<double>::infinity();
+        for (std::size_t i = done; i < loops.size(); ++i) {
+            const auto& [low, high] = boxes[i];
+            double dx = std::max({ low.x - position.x, 0.0, position.x - high.x });
+            double dy = std::max({ low.y - position.y, 0.0, position.y - high.y });
+            if (dx * dx + dy * dy >= best) continue;
+
+            // Последняя точка замкнутой ломаной повторяет первую.
+            for (std::size_t v = 0; v + 1 < loops[i].size(); ++v) {
+                double d = distanceSquared(loops[i][v], position);
+                if (d < best) {
+                    best = d;
+                    bestLoop = i;
+                    bestVertex = v;
+                }
+            }
+        }
+        std::swap(loops[done], loops[bestLoop]);
+        std::swap(boxes[done], boxes[bestLoop]);
+
+        Polyline& loop = loops[done];
+        if (bestVertex != 0) {
+            loop.pop_back();
+            std::rotate(loop.begin(), loop.begin() + static_cast<std::ptrdiff_t>(bestVertex), loop.end());
+            loop.push_back(loop.front());
+        }
+        if (!loop.empty()) position = loop.back();
+    }
+}
+
+Polylines generatePerimeters(const Contours& contours, const PerimeterOptions& options, Contours* infill,
+    std::pmr::memory_resource* resource) {
+    Polylines result(resource);
+    Point_2 position{ 0, 0 };
+
+    // Средняя линия первой дорожки, затем каждая следующая - на spacing внутрь от предыдущей.
+    Contours level = offsetContours(contours, -(options.inset + options.spacing / 2), options.offset, nullptr, resource);
+    for (std::size_t k = 0; k < options.count && !level.empty(); ++k) {
+        if (k > 0) level = offsetContours(level, -options.spacing, options.offset, nullptr, resource);
+
+        Polylines loops(resource);
+        for (const auto& contour : level) {
+            loops.emplace_back();
+            appendLoop(contour, 0, loops.back());
+        }
+        orderLoops(loops, position);
+        for (auto& loop : loops) result.push_back(std::move(loop));
+    }
+
+    if (infill) {
+        if (options.count == 0) *infill = offsetContours(contours, -options.inset, options.offset, nullptr, resource);
+        else if (level.empty()) infill->clear();
+        else *infill = offsetContours(level, -options.spacing / 2, options.offset, nullptr, resource);
+    }
+    return result;
+}
@@ -0,0 +1,52 @@
+﻿/**
+ * @file perimeter.h
+ * @brief Периметры: концентрические проходы вдоль контура перед штриховкой.
+ *
+ * Периметр k проходит на расстоянии inset + spacing * (k + 0.5) внутрь от
+ * контура детали (середина дорожки шириной spacing), штриховка заполняет
+ * область внутри последнего периметра. Каждый следующий периметр строится
+ * эквидистантой предыдущего, поэтому на уже упрощённых (сжавшихся) контурах.
+ *
+ * Порядок прохода: от внешних периметров к внутренним; внутри одного уровня -
+ * жадно к ближайшему контуру, и каждая замкнутая ломаная начинается с вершины,
+ * ближайшей к концу предыдущей, чтобы сократить холостые переходы.
+ */
+
+#pragma once
+
+#include "geometry.h"
+#include "offset.h"
+
+#include <memory_resource>
+
+/**
+ * @brief Параметры периметров.
+ */
+struct PerimeterOptions {
+    /// Число периметров.
+    std::size_t count = 1;
+    /// Расстояние между периметрами (ширина дорожки).
+    double spacing = 1;
+    /// Отступ внешнего края первой дорожки от контура.
+    double inset = 0;
+    /// Углы эквидистант.
+    OffsetOptions offset;
+};
+
+/**
+ * @brief Строит периметры и область для штриховки внутри них.
+ * @param contours Контуры детали.
+ * @param options Параметры.
+ * @param infill Область штриховки (заменяется; может быть nullptr).
+ * @param resource Источник памяти для результата.
+ * @return Замкнутые ломаные периметров в порядке прохода.
+ */
+Polylines generatePerimeters(const Contours& contours, const PerimeterOptions& options, Contours* infill,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+/**
+ * @brief Упорядочивает замкнутые ломаные: жадно к ближайшей, начало - у ближайшей вершины.
+ * @param loops Ломаные (переставляются и поворачиваются на месте).
+ * @param position Положение инструмента перед первой ломаной; на выходе - конец последней.
+ */
+void orderLoops(Polylines& loops, Point_2& position);
@@ -0,0 +1,322 @@
+﻿/**
+ * @file polygon_clip.cpp
+ * @brief Реализация обрезки отрезков по произвольной области.
+ */
+
+#include "polygon_clip.h"
+
+#include "hatcher.h"
+#include "robust_predicates.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/// Квантование направления для поиска таблицы рёбер: микроградусы.
+constexpr double DIRECTION_QUANTUM = 1e6;
+constexpr std::int64_t HALF_TURN = static_cast<std::int64_t>(180 * DIRECTION_QUANTUM);
+
+/// Ориентация точки c относительно прямой ab (> 0 - слева).
+double orientation(const Point_2& a, const Point_2& b, const Point_2& c) {
+    // Знак решает чётность пересечений: почти коллинеарные случаи уточняются точно.
+    return orient2d(a, b, c);
+}
+
+/**
+ * @brief Параметр пересечения звена pq с ребром ab, либо отрицательное число.
+ *
+ * Точки на прямой считаются лежащими по одну (правую) сторону: так вершины
+ * области и концы звеньев, попавшие точно на границу, учитываются согласованно
+ * для соседних рёбер и звеньев, и чётность пересечений не сбивается.
+ */
+double crossingParameter(const Point_2& p, const Point_2& q, const Line_2& edge) {
+    double op = orientation(edge.start, edge.end, p);
+    double oq = orientation(edge.start, edge.end, q);
+    if ((op > 0) == (oq > 0)) return -1;
+    if ((orientation(p, q, edge.start) > 0) == (orientation(p, q, edge.end) > 0)) return -1;
+    return std::clamp(op / (op - oq), 0.0, 1.0);
+}
+
+double signedArea(const Contour& contour) {
+    double area = 0;
+    for (std::size_t i = 0; i < contour.size(); ++i) {
+        const Point_2& a = contour[i];
+        const Point_2& b = contour[(i + 1) % contour.size()];
+        area += a.x * b.y - b.x * a.y;
+    }
+    return area / 2;
+}
+
+} // namespace
+
+bool isConvexContour(const Contour& contour) {
+    std::size_t n = contour.size();
+    if (n < 3) return false;
+
+    int sign = 0;
+    double turning = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const Point_2& a = contour[i];
+        const Point_2& b = contour[(i + 1) % n];
+        const Point_2& c = contour[(i + 2) % n];
+        double ux = b.x - a.x, uy = b.y - a.y;
+        double vx = c.x - b.x, vy = c.y - b.y;
+        double cross = ux * vy - uy * vx;
+        double dot = ux * vx + uy * vy;
+        if (cross != 0) {
+            int s = cross > 0 ? 1 : -1;
+            if (sign != 0 && s != sign) return false;
+            sign = s;
+        }
+        turning += std::atan2(cross, dot);
+    }
+
+    // Звёздчатый контур поворачивает в одну сторону, но делает больше одного оборота.
+    return sign != 0 && std::abs(std::abs(turning) - 2 * std::numbers::pi) < 1e-6;
+}
+
+PolygonClipper::PolygonClipper(const Contours& region, std::pmr::memory_resource* resource)
+    : resource_(resource), region_(region, resource), convexEdges_(resource), crossings_(resource), grid_(resource) {
+    convex_ = region_.size() == 1 && isConvexContour(region_[0]);
+    if (!convex_) return;
+
+    const Contour& contour = region_[0];
+    double orientation = signedArea(contour) > 0 ? 1 : -1;
+    for (std::size_t i = 0; i < contour.size(); ++i) {
+        const Point_2& a = contour[i];
+        const Point_2& b = contour[(i + 1) % contour.size()];
+        if (a.x == b.x && a.y == b.y) continue;
+        // Внутренняя нормаль: слева от ребра для обхода против часовой стрелки.
+        Point_2 normal{ -(b.y - a.y) * orientation, (b.x - a.x) * orientation };
+        convexEdges_.push_back({ a, normal });
+    }
+}
+
+bool PolygonClipper::clipConvex(Line_2& line) const {
+    double dx = line.end.x - line.start.x;
+    double dy = line.end.y - line.start.y;
+    double tEnter = 0;
+    double tLeave = 1;
+
+    for (const auto& edge : convexEdges_) {
+        const Point_2& e = edge.start;
+        const Point_2& n = edge.end;
+        double num = n.x * (line.start.x - e.x) + n.y * (line.start.y - e.y);
+        double den = n.x * dx + n.y * dy;
+
+        if (den == 0) {
+            if (num < 0) return false; // параллельно ребру и снаружи
+            continue;
+        }
+
+        double t = -num / den;
+        if (den > 0) tEnter = std::max(tEnter, t);
+        else tLeave = std::min(tLeave, t);
+        if (tEnter > tLeave) return false;
+    }
+
+    Point_2 start = line.start;
+    line.start = { start.x + dx * tEnter, start.y + dy * tEnter };
+    line.end = { start.x + dx * tLeave, start.y + dy * tLeave };
+    return tLeave > tEnter;
+}
+
+const EdgeIndex& PolygonClipper::tableFor(const Line_2& line) {
+    double angle = std::atan2(line.end.y - line.start.y, line.end.x - line.start.x) * 180.0 / std::numbers::pi;
+    std::int64_t key = std::llround(angle * DIRECTION_QUANTUM) % HALF_TURN;
+    if (key < 0) key += HALF_TURN;
+
+    auto& table = tables_[key];
+    if (!table) {
+        table = std::make_unique<EdgeIndex>(region_, static_cast<double>(key) / DIRECTION_QUANTUM, 0, resource_);
+        ++stats_.edgeTables;
+    }
+    return *table;
+}
+
+void PolygonClipper::clipGeneral(const Line_2& line, Lines& out) {
+    const EdgeIndex& table = tableFor(line);
+    const Point_2& dir = table.direction();
+    const Point_2& perp = table.normal();
+
+    double u0 = dir.x * line.start.x + dir.y * line.start.y;
+    double u1 = dir.x * line.end.x + dir.y * line.end.y;
+    double offset = perp.x * (line.start.x + line.end.x) / 2 + perp.y * (line.start.y + line.end.y) / 2;
+
+    table.intersect(offset, crossings_);
+    if (crossings_.empty()) return;
+
+    double lo = std::min(u0, u1);
+    double hi = std::max(u0, u1);
+    double dx = line.end.x - line.start.x;
+    double dy = line.end.y - line.start.y;
+
+    auto emit = [&](double a, double b) {
+        double ta = (a - u0) / (u1 - u0);
+        double tb = (b - u0) / (u1 - u0);
+        out.push_back({ { line.start.x + dx * ta, line.start.y + dy * ta },
+                        { line.start.x + dx * tb, line.start.y + dy * tb } });
+        ++stats_.pieces;
+    };
+
+    std::size_t pairs = crossings_.size() / 2;
+    for (std::size_t k = 0; k < pairs; ++k) {
+        // Части выдаются от начала отрезка к концу, даже если он направлен против таблицы.
+        std::size_t i = u1 >= u0 ? k : pairs - 1 - k;
+        double a = std::max(crossings_[2 * i], lo);
+        double b = std::min(crossings_[2 * i + 1], hi);
+        if (a >= b) continue;
+        if (u1 >= u0) emit(a, b);
+        else emit(b, a);
+    }
+}
+
+void PolygonClipper::clip(const Line_2& line, Lines& out) {
+    ++stats_.segments;
+    if (line.start.x == line.end.x && line.start.y == line.end.y) return;
+
+    if (convex_) {
+        Line_2 clipped = line;
+        if (clipConvex(clipped)) {
+            out.push_back(clipped);
+            ++stats_.pieces;
+        }
+        return;
+    }
+    clipGeneral(line, out);
+}
+
+void PolygonClipper::clipBatch(const Lines& lines, Lines& out) {
+    out.reserve(out.size() + lines.size());
+    for (const auto& line : lines)
+        clip(line, out);
+}
+
+void PolygonClipper::cellRange(const Point_2& a, const Point_2& b,
+    std::size_t& c0, std::size_t& r0, std::size_t& c1, std::size_t& r1) const {
+    auto cell = [&](double v, double low, std::size_t count) {
+        double index = std::floor((v - low) / grid_.cellSize);
+        if (index <= 0) return std::size_t{ 0 };
+        return std::min(static_cast<std::size_t>(index), count - 1);
+    };
+    c0 = cell(std::min(a.x, b.x), grid_.low.x, grid_.columns);
+    c1 = cell(std::max(a.x, b.x), grid_.low.x, grid_.columns);
+    r0 = cell(std::min(a.y, b.y), grid_.low.y, grid_.rows);
+    r1 = cell(std::max(a.y, b.y), grid_.low.y, grid_.rows);
+}
+
+void PolygonClipper::buildEdgeGrid() {
+    EdgeGrid& grid = grid_;
+    grid.built = true;
+    for (const auto& contour : region_) {
+        for (std::size_t i = 0; i < contour.size(); ++i) {
+            const Point_2& a = contour[i];
+            const Point_2& b = contour[(i + 1) % contour.size()];
+            if (a.x != b.x || a.y != b.y) grid.edges.push_back({ a, b });
+        }
+    }
+
+    if (!computeBounds(region_, grid.low, grid.high)) return;
+    const Point_2& high = grid.high;
+    // Около одного ребра на ячейку при равномерном распределении по периметру.
+    double extent = std::max({ high.x - grid.low.x, high.y - grid.low.y, 1e-9 });
+    double side = std::ceil(std::sqrt(static_cast<double>(grid.edges.size())));
+    grid.cellSize = extent / std::max(side, 1.0);
+    grid.columns = static_cast<std::size_t>((high.x - grid.low.x) / grid.cellSize) + 1;
+    grid.rows = static_cast<std::size_t>((high.y - grid.low.y) / grid.cellSize) + 1;
+
+    // Сортировка подсчётом: сначала число рёбер в ячейках, затем раскладка.
+    grid.cellStart.assign(grid.columns * grid.rows + 1, 0);
+    std::size_t c0, r0, c1, r1;
+    for (const auto& edge : grid.edges) {
+        cellRange(edge.start, edge.end, c0, r0, c1, r1);
+        for (std::size_t r = r0; r <= r1; ++r)
+            for (std::size_t c = c0; c <= c1; ++c)
+                ++grid.cellStart[r * grid.columns + c + 1];
+    }
+    for (std::size_t i = 1; i < grid.cellStart.size(); ++i)
+        grid.cellStart[i] += grid.cellStart[i - 1];
+
+    grid.cellEdges.resize(grid.cellStart.back());
+    std::pmr::vector<std::size_t> fill(grid.cellStart.begin(), grid.cellStart.end() - 1, resource_);
+    for (std::size_t e = 0; e < grid.edges.size(); ++e) {
+        cellRange(grid.edges[e].start, grid.edges[e].end, c0, r0, c1, r1);
+        for (std::size_t r = r0; r <= r1; ++r)
+            for (std::size_t c = c0; c <= c1; ++c)
+                grid.cellEdges[fill[r * grid.columns + c]++] = e;
+    }
+    grid.visited.assign(grid.edges.size(), 0);
+}
+
+template <typename F>
+void PolygonClipper::forEachCandidate(const Point_2& a, const Point_2& b, F&& f) {
+    EdgeGrid& grid = grid_;
+    if (grid.cellEdges.empty()) return;
+    ++grid.query;
+    std::size_t c0, r0, c1, r1;
+    cellRange(a, b, c0, r0, c1, r1);
+    for (std::size_t r = r0; r <= r1; ++r) {
+        for (std::size_t c = c0; c <= c1; ++c) {
+            std::size_t cell = r * grid.columns + c;
+            for (std::size_t k = grid.cellStart[cell]; k < grid.cellStart[cell + 1]; ++k) {
+                std::size_t e = grid.cellEdges[k];
+                if (grid.visited[e] == grid.query) continue;
+                grid.visited[e] = grid.query;
+                f(grid.edges[e]);
+            }
+        }
+    }
+}
+
+void PolygonClipper::clipPolyline(const Polyline& polyline, Polylines& out) {
+    if (polyline.size() < 2) return;
+    if (!grid_.built) buildEdgeGrid();
+
+    // Начальное состояние - по чётности пересечений луча из точки за пределами области.
+    const Point_2& first = polyline.front();
+    Point_2 far{ grid_.low.x - 1, first.y };
+    bool inside = false;
+    for (const auto& edge : grid_.edges)
+        if (crossingParameter(far, first, edge) >= 0) inside = !inside;
+
+    Polyline current(out.get_allocator());
+    if (inside) current.push_back(first);
+
+    auto flush = [&] {
+        if (current.size() >= 2) {
+            out.push_back(std::move(current));
+            ++stats_.pieces;
+        }
+        current = Polyline(out.get_allocator());
+    };
+
+    for (std::size_t i = 1; i < polyline.size(); ++i) {
+        const Point_2& p = polyline[i - 1];
+        const Point_2& q = polyline[i];
+        ++stats_.segments;
+        if (p.x == q.x && p.y == q.y) continue;
+
+        // Звено по одну сторону рамки области не пересекает её рёбер.
+        if (computeOutCode(p.x, p.y, grid_.low, grid_.high) & computeOutCode(q.x, q.y, grid_.low, grid_.high)) {
+            if (inside) current.push_back(q);
+            continue;
+        }
+
+        crossings_.clear();
+        forEachCandidate(p, q, [&](const Line_2& edge) {
+            double t = crossingParameter(p, q, edge);
+            if (t >= 0) crossings_.push_back(t);
+        });
+        std::sort(crossings_.begin(), crossings_.end());
+
+        for (double t : crossings_) {
+            Point_2 x{ p.x + (q.x - p.x) * t, p.y + (q.y - p.y) * t };
+            current.push_back(x);
+            if (inside) flush();
+            inside = !inside;
+        }
+        if (inside) current.push_back(q);
+    }
+    if (inside) flush();
+}
@@ -0,0 +1,134 @@
+﻿/**
+ * @file polygon_clip.h
+ * @brief Обрезка отрезков по произвольной области (многоугольники с дырами).
+ *
+ * clipLine обрезает только по осевому прямоугольнику. Здесь область задаётся
+ * контурами (правило чётности): зоны платформы, маски исключения и т.п.
+ *
+ * - Выпуклая область из одного контура обрезается алгоритмом Кируса–Бека:
+ *   один проход по рёбрам на отрезок, без сортировок и выделений памяти.
+ * - Произвольная область обрезается через таблицу рёбер (EdgeIndex) для
+ *   направления отрезка: отрезок проверяет только рёбра своей корзины,
+ *   а пересечения с учётом чётности дают внутренние интервалы. Таблица
+ *   строится один раз на направление и переиспользуется всеми параллельными
+ *   отрезками пакета - для штриховки это одна таблица на весь пакет.
+ * - Ломаные (спирали, узоры заполнения) меняют направление на каждом звене,
+ *   поэтому обрезаются через равномерную сетку рёбер области: звено вне рамки
+ *   области отбрасывается кодами Коэна–Сазерленда (как в clipLine), остальные
+ *   проверяют рёбра своих ячеек, состояние "внутри/снаружи" переключается в точках
+ *   пересечения, и непрерывные внутренние участки выдаются одной ломаной.
+ */
+
+#pragma once
+
+#include "geometry.h"
+#include "edge_index.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+
+/**
+ * @brief Счётчики обрезки.
+ */
+struct PolygonClipStats {
+    /// Обработано отрезков.
+    std::size_t segments = 0;
+    /// Получено отрезков (отрезок может распасться на несколько частей).
+    std::size_t pieces = 0;
+    /// Построено таблиц рёбер (по одной на направление).
+    std::size_t edgeTables = 0;
+};
+
+/**
+ * @brief Обрезчик отрезков по области из контуров.
+ *
+ * Не потокобезопасен (кэширует таблицы рёбер по направлениям).
+ */
+class PolygonClipper {
+public:
+    /**
+     * @brief Создаёт обрезчик.
+     * @param region Контуры области (правило чётности).
+     * @param resource Источник памяти для таблиц рёбер.
+     */
+    explicit PolygonClipper(const Contours& region,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /// Используется ли быстрый путь для выпуклой области.
+    bool isConvex() const { return convex_; }
+
+    /**
+     * @brief Обрезает один отрезок.
+     * @param line Отрезок.
+     * @param out Части отрезка внутри области (дописываются, в порядке от начала к концу).
+     */
+    void clip(const Line_2& line, Lines& out);
+
+    /**
+     * @brief Обрезает пакет отрезков.
+     * @param lines Отрезки.
+     * @param out Части отрезков внутри области (дописываются).
+     */
+    void clipBatch(const Lines& lines, Lines& out);
+
+    /**
+     * @brief Обрезает ломаную.
+     * @param polyline Ломаная.
+     * @param out Непрерывные участки внутри области (дописываются, в порядке прохода).
+     */
+    void clipPolyline(const Polyline& polyline, Polylines& out);
+
+    /// Счётчики.
+    const PolygonClipStats& stats() const { return stats_; }
+
+private:
+    bool clipConvex(Line_2& line) const;
+    void clipGeneral(const Line_2& line, Lines& out);
+    const EdgeIndex& tableFor(const Line_2& line);
+    void buildEdgeGrid();
+    void cellRange(const Point_2& a, const Point_2& b,
+        std::size_t& c0, std::size_t& r0, std::size_t& c1, std::size_t& r1) const;
+    template <typename F>
+    void forEachCandidate(const Point_2& a, const Point_2& b, F&& f);
+
+    std::pmr::memory_resource* resource_;
+    Contours region_;
+    bool convex_ = false;
+    /// Рёбра выпуклой области: точка и внутренняя нормаль.
+    std::pmr::vector<Line_2> convexEdges_;
+
+    /// Таблицы рёбер по квантованному направлению (микроградусы в [0, 180)).
+    std::map<std::int64_t, std::unique_ptr<EdgeIndex>> tables_;
+    std::pmr::vector<double> crossings_;
+
+    /// Равномерная сетка рёбер области для обрезки ломаных (строится при первом вызове).
+    struct EdgeGrid {
+        explicit EdgeGrid(std::pmr::memory_resource* resource)
+            : edges(resource), cellStart(resource), cellEdges(resource), visited(resource) {}
+
+        bool built = false;
+        Point_2 low{};
+        Point_2 high{};
+        double cellSize = 1;
+        std::size_t columns = 1;
+        std::size_t rows = 1;
+        std::pmr::vector<Line_2> edges;
+        std::pmr::vector<std::size_t> cellStart;
+        std::pmr::vector<std::size_t> cellEdges;
+        /// Метка последнего запроса по ребру, чтобы ребро из нескольких ячеек проверялось один раз.
+        std::pmr::vector<std::size_t> visited;
+        std::size_t query = 0;
+    };
+    EdgeGrid grid_;
+
+    PolygonClipStats stats_;
+};
+
+/**
+ * @brief Проверяет выпуклость простого контура.
+ * @param contour Контур.
+ * @return true, если все повороты одного знака и контур делает ровно один оборот.
+ */
+bool isConvexContour(const Contour& contour);
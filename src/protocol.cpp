@@ -0,0 +1,99 @@
+﻿/**
+ * @file protocol.cpp
+ * @brief Реализация кодирования сообщений протокола.
+ */
+
+#include "protocol.h"
+
+#include <cstring>
+
+namespace {
+
+template <typename T>
+void put(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof value);
+}
+
+/**
+ * @brief Последовательное чтение значений из тела с контролем границ.
+ */
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data_(data) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (data_.size() - pos_ < sizeof value) return false;
+        std::memcpy(&value, data_.data() + pos_, sizeof value);
+        pos_ += sizeof value;
+        return true;
+    }
+
+    bool getBytes(void* target, std::size_t size) {
+        if (data_.size() - pos_ < size) return false;
+        std::memcpy(target, data_.data() + pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    std::size_t remaining() const { return data_.size() - pos_; }
+    std::string_view rest() const { return data_.substr(pos_); }
+
+private:
+    std::string_view data_;
+    std::size_t pos_ = 0;
+};
+
+} // namespace
+
+void encodeRequest(const HatchRequest& request, std::string& body) {
+    body.clear();
+    put(body, static_cast<std::uint8_t>(request.format));
+    put(body, request.angleDegrees);
+    put(body, request.step);
+    put(body, static_cast<std::uint32_t>(request.contours.size()));
+    for (const auto& contour : request.contours) {
+        put(body, static_cast<std::uint32_t>(contour.size()));
+        body.append(reinterpret_cast<const char*>(contour.data()), contour.size() * sizeof(Point_2));
+    }
+}
+
+bool decodeRequest(std::string_view body, HatchRequest& request) {
+    Reader reader(body);
+    std::uint8_t format = 0;
+    std::uint32_t contourCount = 0;
+    if (!reader.get(format) || !reader.get(request.angleDegrees) || !reader.get(request.step)
+        || !reader.get(contourCount))
+        return false;
+    if (format > static_cast<std::uint8_t>(OutputFormat::Svg)) return false;
+    request.format = static_cast<OutputFormat>(format);
+
+    // Каждый контур занимает минимум 4 байта - защита от огромного resize.
+    if (contourCount > reader.remaining() / sizeof(std::uint32_t)) return false;
+    request.contours.resize(contourCount);
+    for (auto& contour : request.contours) {
+        std::uint32_t pointCount = 0;
+        if (!reader.get(pointCount) || pointCount > reader.remaining() / sizeof(Point_2)) return false;
+        contour.resize(pointCount);
+        if (!reader.getBytes(contour.data(), pointCount * sizeof(Point_2))) return false;
+    }
+    return reader.remaining() == 0;
+}
+
+void encodeResponseHeader(bool ok, OutputFormat format, std::string& body) {
+    body.clear();
+    put(body, static_cast<std::uint8_t>(ok ? 0 : 1));
+    put(body, static_cast<std::uint8_t>(format));
+}
+
+bool decodeResponse(std::string_view body, HatchResponse& response) {
+    Reader reader(body);
+    std::uint8_t status = 0;
+    std::uint8_t format = 0;
+    if (!reader.get(status) || !reader.get(format)) return false;
+    if (format > static_cast<std::uint8_t>(OutputFormat::Svg)) return false;
+    response.ok = status == 0;
+    response.format = static_cast<OutputFormat>(format);
+    response.payload.assign(reader.rest());
+    return true;
+}
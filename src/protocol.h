@@ -0,0 +1,85 @@
+﻿/**
+ * @file protocol.h
+ * @brief Двоичный протокол обмена с сервером штриховки.
+ *
+ * Каждое сообщение - кадр: сигнатура (4 байта), длина тела (uint64), тело.
+ * Числа передаются в порядке байтов хоста (клиент и сервер на одной машине).
+ *
+ * Тело запроса: формат ответа (uint8), угол (double), шаг (double),
+ * число контуров (uint32), затем для каждого контура число точек (uint32)
+ * и точки (пары double).
+ *
+ * Тело ответа: статус (uint8, 0 - успех), формат (uint8), полезная нагрузка
+ * до конца кадра - результат в запрошенном формате либо текст ошибки.
+ */
+
+#pragma once
+
+#include "geometry.h"
+#include "output_writers.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/// Сигнатура кадра запроса.
+constexpr char REQUEST_MAGIC[4] = { 'H', 'R', 'Q', '1' };
+/// Сигнатура кадра ответа.
+constexpr char RESPONSE_MAGIC[4] = { 'H', 'R', 'S', '1' };
+/// Предельный размер тела кадра.
+constexpr std::uint64_t MAX_FRAME_BYTES = std::uint64_t(1) << 30;
+
+/**
+ * @brief Запрос на штриховку.
+ */
+struct HatchRequest {
+    OutputFormat format = OutputFormat::Binary;
+    double angleDegrees = 45;
+    double step = 1;
+    Contours contours;
+};
+
+/**
+ * @brief Ответ сервера.
+ */
+struct HatchResponse {
+    bool ok = false;
+    OutputFormat format = OutputFormat::Binary;
+    /// Результат в запрошенном формате либо текст ошибки.
+    std::string payload;
+};
+
+/**
+ * @brief Кодирует тело запроса.
+ * @param request Запрос.
+ * @param body Выходной буфер (заменяется).
+ */
+void encodeRequest(const HatchRequest& request, std::string& body);
+
+/**
+ * @brief Декодирует тело запроса.
+ *
+ * Векторы контуров в request переиспользуются, поэтому повторное
+ * декодирование в тот же объект почти не выделяет память.
+ *
+ * @param body Тело кадра.
+ * @param request Результат.
+ * @return false, если тело повреждено.
+ */
+bool decodeRequest(std::string_view body, HatchRequest& request);
+
+/**
+ * @brief Кодирует заголовок тела ответа (статус и формат); нагрузка дописывается следом.
+ * @param ok Успех.
+ * @param format Формат нагрузки.
+ * @param body Выходной буфер (заменяется).
+ */
+void encodeResponseHeader(bool ok, OutputFormat format, std::string& body);
+
+/**
+ * @brief Декодирует тело ответа.
+ * @param body Тело кадра.
+ * @param response Результат.
+ * @return false, если тело повреждено.
+ */
+bool decodeResponse(std::string_view body, HatchResponse& response);
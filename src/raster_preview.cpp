@@ -0,0 +1,269 @@
+﻿/**
+ * @file raster_preview.cpp
+ * @brief Реализация растрового предпросмотра.
+ */
+
+#include "raster_preview.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/// Строк изображения в полосе одного потока.
+constexpr std::size_t BAND_ROWS = 32;
+/// Наибольший объём данных в deflate-блоке без сжатия.
+constexpr std::size_t STORED_BLOCK = 65535;
+
+/// Насыщенность штриховки, ломаных и контуров.
+constexpr double HATCH_INK = 0.6;
+constexpr double PATH_INK = 0.8;
+constexpr double CONTOUR_INK = 1.0;
+
+/// Отрезок в координатах изображения (x вправо, y вниз, центр пикселя - целое).
+struct Stroke {
+    double x0, y0, x1, y1;
+    double ink;
+};
+
+/// Рисует отрезки полосы строк [top, bottom) изображения.
+class BandRasterizer {
+public:
+    BandRasterizer(GrayImage& image, std::size_t top, std::size_t bottom)
+        : image_(image), top_(static_cast<long>(top)), bottom_(static_cast<long>(bottom)) {}
+
+    /// Сглаженный отрезок (Ву): шаг по главной оси, два пикселя поперёк неё.
+    void draw(const Stroke& s) {
+        double x0 = s.x0, y0 = s.y0, x1 = s.x1, y1 = s.y1;
+        bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+        if (steep) {
+            std::swap(x0, y0);
+            std::swap(x1, y1);
+        }
+        if (x0 > x1) {
+            std::swap(x0, x1);
+            std::swap(y0, y1);
+        }
+        double gradient = x1 > x0 ? (y1 - y0) / (x1 - x0) : 0;
+
+        double first = std::round(x0);
+        double last = std::round(x1);
+        if (steep) {
+            // Главная ось - строки: берутся только строки полосы.
+            first = std::max(first, static_cast<double>(top_));
+            last = std::min(last, static_cast<double>(bottom_ - 1));
+        }
+        else if (gradient != 0) {
+            // Главная ось - столбцы: только те, где линия проходит через полосу (с запасом в пиксель).
+            double a = x0 + (static_cast<double>(top_) - 1 - y0) / gradient;
+            double b = x0 + (static_cast<double>(bottom_) - y0) / gradient;
+            first = std::max(first, std::floor(std::min(a, b)));
+            last = std::min(last, std::ceil(std::max(a, b)));
+        }
+
+        for (double major = first; major <= last; ++major) {
+            double minor = y0 + gradient * (major - x0);
+            double base = std::floor(minor);
+            double fraction = minor - base;
+            if (steep) {
+                plot(base, major, (1 - fraction) * s.ink);
+                plot(base + 1, major, fraction * s.ink);
+            }
+            else {
+                plot(major, base, (1 - fraction) * s.ink);
+                plot(major, base + 1, fraction * s.ink);
+            }
+        }
+    }
+
+private:
+    void plot(double x, double y, double coverage) {
+        auto px = static_cast<long>(x);
+        auto py = static_cast<long>(y);
+        if (py < top_ || py >= bottom_ || px < 0 || px >= static_cast<long>(image_.width())) return;
+        std::uint8_t& pixel = image_.row(static_cast<std::size_t>(py))[px];
+        pixel = static_cast<std::uint8_t>(std::min(255.0, pixel + std::round(coverage * 255)));
+    }
+
+    GrayImage& image_;
+    long top_;
+    long bottom_;
+};
+
+/// Таблица CRC-32 (многочлен 0xEDB88320), как в PNG и zlib.
+const std::array<std::uint32_t, 256>& crcTable() {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+std::uint32_t updateCrc(std::uint32_t crc, const std::string& data) {
+    for (unsigned char byte : data) crc = crcTable()[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+void appendBigEndian(std::string& out, std::uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<char>((value >> shift) & 0xFF));
+}
+
+/// Блок PNG: длина, тип, данные, CRC типа и данных.
+void writeChunk(std::ostream& out, const std::string& type, const std::string& data) {
+    std::string length;
+    appendBigEndian(length, static_cast<std::uint32_t>(data.size()));
+    std::string crc;
+    appendBigEndian(crc, updateCrc(updateCrc(0xFFFFFFFFu, type), data) ^ 0xFFFFFFFFu);
+    out << length << type;
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    out << crc;
+}
+
+} // namespace
+
+GrayImage renderPreview(const Polylines& perimeters, const Lines& lines, const Contours& contours,
+    const PreviewOptions& options) {
+    if (options.size <= 2 * options.margin) throw std::invalid_argument("Preview size must exceed the margins");
+
+    // Рамка всех элементов, а не только контуров: узоры и штриховка могут выходить за них.
+    Point_2 low{};
+    Point_2 high{};
+    bool found = computeBounds(contours, low, high);
+    auto extend = [&](const Point_2& p) {
+        if (!found) {
+            low = high = p;
+            found = true;
+        }
+        low = { std::min(low.x, p.x), std::min(low.y, p.y) };
+        high = { std::max(high.x, p.x), std::max(high.y, p.y) };
+    };
+    for (const auto& line : lines) {
+        extend(line.start);
+        extend(line.end);
+    }
+    for (const auto& polyline : perimeters) {
+        for (const auto& p : polyline) extend(p);
+    }
+
+    auto drawable = static_cast<double>(options.size - 2 * options.margin);
+    double extent = found ? std::max(high.x - low.x, high.y - low.y) : 0;
+    double scale = extent > 0 ? drawable / extent : 1;
+    auto margin = static_cast<double>(options.margin);
+    GrayImage image(static_cast<std::size_t>(std::ceil((high.x - low.x) * scale)) + 2 * options.margin,
+                    static_cast<std::size_t>(std::ceil((high.y - low.y) * scale)) + 2 * options.margin);
+
+    std::vector<Stroke> strokes;
+    strokes.reserve(lines.size() + perimeters.size() + contours.size());
+    auto add = [&](const Point_2& a, const Point_2& b, double ink) {
+        strokes.push_back({ margin + (a.x - low.x) * scale, margin + (high.y - a.y) * scale,
+                            margin + (b.x - low.x) * scale, margin + (high.y - b.y) * scale, ink });
+    };
+    for (const auto& line : lines) add(line.start, line.end, HATCH_INK);
+    for (const auto& polyline : perimeters) {
+        for (std::size_t i = 0; i + 1 < polyline.size(); ++i) add(polyline[i], polyline[i + 1], PATH_INK);
+    }
+    for (const auto& contour : contours) {
+        for (std::size_t i = 0; i < contour.size(); ++i)
+            add(contour[i], contour[(i + 1) % contour.size()], CONTOUR_INK);
+    }
+
+    // Раскладка отрезков по полосам (подсчёт, затем заполнение), как у сетки рёбер.
+    std::size_t bands = (image.height() + BAND_ROWS - 1) / BAND_ROWS;
+    auto bandRange = [&](const Stroke& s, std::size_t& first, std::size_t& last) {
+        double top = std::max(std::floor(std::min(s.y0, s.y1)) - 1, 0.0);
+        double bottom = std::max(std::ceil(std::max(s.y0, s.y1)) + 1, 0.0);
+        first = std::min(static_cast<std::size_t>(top) / BAND_ROWS, bands - 1);
+        last = std::min(static_cast<std::size_t>(bottom) / BAND_ROWS, bands - 1);
+    };
+    std::vector<std::size_t> bandStart(bands + 1, 0);
+    std::size_t first = 0, last = 0;
+    for (const auto& s : strokes) {
+        bandRange(s, first, last);
+        for (std::size_t b = first; b <= last; ++b) ++bandStart[b + 1];
+    }
+    for (std::size_t b = 0; b < bands; ++b) bandStart[b + 1] += bandStart[b];
+    std::vector<std::uint32_t> bandStrokes(bandStart.back());
+    std::vector<std::size_t> fill(bandStart.begin(), bandStart.end() - 1);
+    for (std::uint32_t i = 0; i < strokes.size(); ++i) {
+        bandRange(strokes[i], first, last);
+        for (std::size_t b = first; b <= last; ++b) bandStrokes[fill[b]++] = i;
+    }
+
+    {
+        ThreadPool pool(std::min(options.threads, bands));
+        for (std::size_t b = 0; b < bands; ++b) {
+            pool.submit([&, b] {
+                BandRasterizer band(image, b * BAND_ROWS, std::min((b + 1) * BAND_ROWS, image.height()));
+                for (std::size_t k = bandStart[b]; k < bandStart[b + 1]; ++k) band.draw(strokes[bandStrokes[k]]);
+            });
+        }
+        // Деструктор пула дожидается всех полос.
+    }
+    return image;
+}
+
+void writePgm(std::ostream& out, const GrayImage& image) {
+    out << "P5\n" << image.width() << " " << image.height() << "\n255\n";
+    std::vector<char> row(image.width());
+    for (std::size_t y = 0; y < image.height(); ++y) {
+        const std::uint8_t* ink = image.row(y);
+        for (std::size_t x = 0; x < image.width(); ++x) row[x] = static_cast<char>(255 - ink[x]);
+        out.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+}
+
+void writePng(std::ostream& out, const GrayImage& image) {
+    static const char signature[] = { '\x89', 'P', 'N', 'G', '\r', '\n', '\x1A', '\n' };
+    out.write(signature, sizeof signature);
+
+    std::string header;
+    appendBigEndian(header, static_cast<std::uint32_t>(image.width()));
+    appendBigEndian(header, static_cast<std::uint32_t>(image.height()));
+    // 8 бит, оттенки серого, deflate, без фильтров, без чересстрочности.
+    header += std::string{ 8, 0, 0, 0, 0 };
+    writeChunk(out, "IHDR", header);
+
+    // Несжатые данные: у каждой строки байт фильтра 0.
+    std::string raw;
+    raw.reserve((image.width() + 1) * image.height());
+    for (std::size_t y = 0; y < image.height(); ++y) {
+        raw.push_back(0);
+        const std::uint8_t* ink = image.row(y);
+        for (std::size_t x = 0; x < image.width(); ++x) raw.push_back(static_cast<char>(255 - ink[x]));
+    }
+
+    // Поток zlib: заголовок, deflate-блоки stored, Adler-32.
+    std::string zlib{ '\x78', '\x01' };
+    zlib.reserve(raw.size() + raw.size() / STORED_BLOCK * 5 + 16);
+    std::size_t offset = 0;
+    do {
+        std::size_t length = std::min(STORED_BLOCK, raw.size() - offset);
+        bool final = offset + length == raw.size();
+        zlib.push_back(final ? 1 : 0);
+        zlib.push_back(static_cast<char>(length & 0xFF));
+        zlib.push_back(static_cast<char>(length >> 8));
+        zlib.push_back(static_cast<char>(~length & 0xFF));
+        zlib.push_back(static_cast<char>((~length >> 8) & 0xFF));
+        zlib.append(raw, offset, length);
+        offset += length;
+    } while (offset < raw.size());
+
+    std::uint32_t a = 1, b = 0;
+    for (unsigned char byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    appendBigEndian(zlib, (b << 16) | a);
+
+    writeChunk(out, "IDAT", zlib);
+    writeChunk(out, "IEND", {});
+}
@@ -0,0 +1,238 @@
+﻿/**
+ * @file result_cache.cpp
+ * @brief Реализация дискового кэша результатов штриховки.
+ */
+
+#include "result_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/// Сигнатура файла записи.
+constexpr char CACHE_MAGIC[4] = { 'H', 'T', 'C', 'H' };
+/// Версия формата записи; меняется и тогда, когда те же ключи дают другие линии.
+constexpr std::uint32_t CACHE_VERSION = 2;
+/// Расширение файлов записей.
+constexpr const char* CACHE_EXTENSION = ".bin";
+/// Расширение временных файлов.
+constexpr const char* TEMP_EXTENSION = ".tmp";
+/// Возраст, после которого временный файл считается брошенным.
+constexpr auto STALE_TEMP_AGE = std::chrono::hours(1);
+
+/// Финализатор splitmix64: хорошо перемешивает биты слова.
+std::uint64_t splitmix(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+std::uint64_t bitsOf(double value) {
+    if (value == 0) value = 0; // -0.0 и 0.0 дают одинаковый ключ
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    return bits;
+}
+
+/// Имя временного файла: случайное слово процесса и номер записи в нём, чтобы писатели не делили файл.
+std::string tempName(const std::string& name) {
+    static const std::uint64_t process = splitmix((std::uint64_t{ std::random_device{}() } << 32) ^ std::random_device{}());
+    static std::atomic<std::uint64_t> writes{ 0 };
+    return name + "." + HatchCacheKey{ process, writes.fetch_add(1, std::memory_order_relaxed) }.hex() + TEMP_EXTENSION;
+}
+
+} // namespace
+
+std::string HatchCacheKey::hex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        text[15 - i] = digits[(high >> (4 * i)) & 0xf];
+        text[31 - i] = digits[(low >> (4 * i)) & 0xf];
+    }
+    return text;
+}
+
+void HatchCacheKeyBuilder::mix(std::uint64_t word) {
+    high_ = splitmix(high_ ^ word);
+    low_ = splitmix(low_ + word * 0xff51afd7ed558ccdull);
+}
+
+HatchCacheKeyBuilder& HatchCacheKeyBuilder::add(double value) {
+    mix(bitsOf(value));
+    return *this;
+}
+
+HatchCacheKeyBuilder& HatchCacheKeyBuilder::add(std::string_view text) {
+    mix(text.size());
+    for (std::size_t i = 0; i < text.size(); i += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, text.data() + i, std::min<std::size_t>(8, text.size() - i));
+        mix(word);
+    }
+    return *this;
+}
+
+HatchCacheKeyBuilder& HatchCacheKeyBuilder::add(const Contours& contours) {
+    mix(contours.size());
+    for (const auto& contour : contours) {
+        mix(contour.size());
+        for (const auto& p : contour) {
+            mix(bitsOf(p.x));
+            mix(bitsOf(p.y));
+        }
+    }
+    return *this;
+}
+
+HatchResultCache::HatchResultCache(fs::path directory, std::uintmax_t maxBytes)
+    : directory_(std::move(directory)), maxBytes_(maxBytes) {
+    fs::create_directories(directory_);
+
+    struct Found {
+        Entry entry;
+        fs::file_time_type time;
+    };
+    std::vector<Found> found;
+
+    auto now = fs::file_time_type::clock::now();
+    for (const auto& item : fs::directory_iterator(directory_)) {
+        if (!item.is_regular_file()) continue;
+        std::error_code ec;
+        auto time = item.last_write_time(ec);
+        if (ec) continue;
+        if (item.path().extension() == TEMP_EXTENSION) {
+            // Свежий временный файл может дописывать другой процесс.
+            if (now - time > STALE_TEMP_AGE) fs::remove(item.path(), ec);
+            continue;
+        }
+        if (item.path().extension() != CACHE_EXTENSION) continue;
+        found.push_back({ { item.path().stem().string(), item.file_size() }, time });
+    }
+
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.time > b.time; });
+    for (auto& f : found) {
+        stats_.bytes += f.entry.size;
+        lru_.push_back(std::move(f.entry));
+        entries_[lru_.back().name] = std::prev(lru_.end());
+    }
+
+    evict();
+}
+
+bool HatchResultCache::get(const HatchCacheKey& key, Lines& lines) {
+    auto found = entries_.find(key.hex());
+    if (found == entries_.end()) {
+        ++stats_.misses;
+        return false;
+    }
+
+    fs::path path = directory_ / (found->first + CACHE_EXTENSION);
+    std::ifstream in(path, std::ios::binary);
+
+    char magic[4] = {};
+    std::uint32_t version = 0;
+    std::uint64_t count = 0;
+    in.read(magic, sizeof magic);
+    in.read(reinterpret_cast<char*>(&version), sizeof version);
+    in.read(reinterpret_cast<char*>(&count), sizeof count);
+
+    std::uintmax_t expected = sizeof magic + sizeof version + sizeof count + count * sizeof(Line_2);
+    if (!in || std::memcmp(magic, CACHE_MAGIC, sizeof magic) != 0 || version != CACHE_VERSION
+        || expected != found->second->size) {
+        in.close();
+        erase(found->second);
+        ++stats_.misses;
+        return false;
+    }
+
+    lines.resize(count);
+    in.read(reinterpret_cast<char*>(lines.data()), static_cast<std::streamsize>(count * sizeof(Line_2)));
+    if (!in) {
+        in.close();
+        lines.clear();
+        erase(found->second);
+        ++stats_.misses;
+        return false;
+    }
+
+    touch(found->second);
+    ++stats_.hits;
+    return true;
+}
+
+void HatchResultCache::put(const HatchCacheKey& key, const Lines& lines) {
+    std::string name = key.hex();
+    fs::path path = directory_ / (name + CACHE_EXTENSION);
+    fs::path temp = directory_ / tempName(name);
+
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        std::uint64_t count = lines.size();
+        out.write(CACHE_MAGIC, sizeof CACHE_MAGIC);
+        out.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof CACHE_VERSION);
+        out.write(reinterpret_cast<const char*>(&count), sizeof count);
+        out.write(reinterpret_cast<const char*>(lines.data()), static_cast<std::streamsize>(count * sizeof(Line_2)));
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            fs::remove(temp, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        return;
+    }
+
+    if (auto found = entries_.find(name); found != entries_.end()) {
+        stats_.bytes -= found->second->size;
+        lru_.erase(found->second);
+        entries_.erase(found);
+    }
+
+    std::uintmax_t size = fs::file_size(path, ec);
+    if (ec) size = 0;
+    lru_.push_front({ name, size });
+    entries_[name] = lru_.begin();
+    stats_.bytes += size;
+    ++stats_.stores;
+
+    evict();
+}
+
+void HatchResultCache::touch(std::list<Entry>::iterator it) {
+    lru_.splice(lru_.begin(), lru_, it);
+
+    // Время изменения файла - это время последнего обращения для следующих запусков.
+    std::error_code ec;
+    fs::last_write_time(directory_ / (it->name + CACHE_EXTENSION), fs::file_time_type::clock::now(), ec);
+}
+
+void HatchResultCache::erase(std::list<Entry>::iterator it) {
+    std::error_code ec;
+    fs::remove(directory_ / (it->name + CACHE_EXTENSION), ec);
+    stats_.bytes -= it->size;
+    entries_.erase(it->name);
+    lru_.erase(it);
+}
+
+void HatchResultCache::evict() {
+    while (stats_.bytes > maxBytes_ && !lru_.empty()) {
+        erase(std::prev(lru_.end()));
+        ++stats_.evictions;
+    }
+}
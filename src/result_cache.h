@@ -0,0 +1,123 @@
+﻿/**
+ * @file result_cache.h
+ * @brief Дисковый кэш результатов штриховки, адресуемый по содержимому.
+ *
+ * Ключ - хэш точек контуров и параметров штриховки (угол, шаг, режим обрезки).
+ * Значение - двоичный блок линий в отдельном файле `<ключ>.bin` каталога кэша.
+ * Суммарный размер файлов ограничен; при переполнении удаляются давно
+ * не использованные записи (LRU по времени последнего обращения).
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief 128-битный ключ записи кэша.
+ */
+struct HatchCacheKey {
+    std::uint64_t high = 0;
+    std::uint64_t low = 0;
+
+    /// Шестнадцатеричное представление (имя файла записи).
+    std::string hex() const;
+};
+
+/**
+ * @brief Построитель ключа: последовательно хэширует входные данные задания.
+ */
+class HatchCacheKeyBuilder {
+public:
+    /// Добавляет число.
+    HatchCacheKeyBuilder& add(double value);
+    /// Добавляет строку (например, описание режима обрезки).
+    HatchCacheKeyBuilder& add(std::string_view text);
+    /// Добавляет все точки всех контуров вместе с их количеством.
+    HatchCacheKeyBuilder& add(const Contours& contours);
+
+    /// Возвращает ключ.
+    HatchCacheKey key() const { return { high_, low_ }; }
+
+private:
+    void mix(std::uint64_t word);
+
+    std::uint64_t high_ = 0x6a09e667f3bcc908ull;
+    std::uint64_t low_ = 0xbb67ae8584caa73bull;
+};
+
+/**
+ * @brief Счётчики работы кэша.
+ */
+struct HatchCacheStats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t stores = 0;
+    std::size_t evictions = 0;
+    /// Текущий суммарный размер записей в байтах.
+    std::uintmax_t bytes = 0;
+};
+
+/**
+ * @brief Дисковый кэш с ограничением размера и вытеснением LRU.
+ *
+ * При создании сканирует каталог, поэтому записи предыдущих запусков
+ * учитываются в размере и порядке вытеснения. Запись файла атомарна
+ * (через временный файл и переименование); имя временного файла своё
+ * у каждой записи, так что процессы с общим каталогом не пишут в один файл.
+ * Повреждённые записи считаются промахом и удаляются, а временные файлы
+ * старше часа (оставленные упавшими процессами) удаляются при открытии.
+ */
+class HatchResultCache {
+public:
+    /**
+     * @brief Открывает (или создаёт) каталог кэша.
+     * @param directory Каталог кэша.
+     * @param maxBytes Предельный суммарный размер записей.
+     * @throws std::filesystem::filesystem_error если каталог нельзя создать.
+     */
+    HatchResultCache(std::filesystem::path directory, std::uintmax_t maxBytes);
+
+    /**
+     * @brief Ищет запись.
+     * @param key Ключ.
+     * @param lines Результат при попадании (заменяется).
+     * @return true при попадании.
+     */
+    bool get(const HatchCacheKey& key, Lines& lines);
+
+    /**
+     * @brief Сохраняет запись и при необходимости вытесняет старые.
+     * @param key Ключ.
+     * @param lines Линии штриховки.
+     */
+    void put(const HatchCacheKey& key, const Lines& lines);
+
+    /// Счётчики.
+    const HatchCacheStats& stats() const { return stats_; }
+
+private:
+    struct Entry {
+        std::string name;
+        std::uintmax_t size;
+    };
+
+    void touch(std::list<Entry>::iterator it);
+    void erase(std::list<Entry>::iterator it);
+    void evict();
+
+    std::filesystem::path directory_;
+    std::uintmax_t maxBytes_;
+
+    /// Записи от самой свежей к самой старой.
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> entries_;
+
+    HatchCacheStats stats_;
+};
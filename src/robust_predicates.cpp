@@ -0,0 +1,97 @@
+﻿/**
+ * @file robust_predicates.cpp
+ * @brief Реализация устойчивого предиката ориентации.
+ */
+
+#include "robust_predicates.h"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+
+/// Точных пересчётов с последнего сброса.
+std::atomic<std::uint64_t> totalFallbacks{ 0 };
+
+/// a + b = sum + error точно.
+void twoSum(double a, double b, double& sum, double& error) {
+    sum = a + b;
+    double bVirtual = sum - a;
+    double aVirtual = sum - bVirtual;
+    error = (a - aVirtual) + (b - bVirtual);
+}
+
+/// a - b = difference + error точно.
+void twoDiff(double a, double b, double& difference, double& error) {
+    difference = a - b;
+    double bVirtual = a - difference;
+    double aVirtual = difference + bVirtual;
+    error = (a - aVirtual) + (bVirtual - b);
+}
+
+/// Неперекрывающееся разложение: компоненты по возрастанию модуля, сумма точна.
+struct Expansion {
+    /// 2 x 2 произведения двучленов по два слагаемых на каждое, у двух членов определителя.
+    std::array<double, 16> terms{};
+    std::size_t size = 0;
+
+    /// Прибавляет число без потерь (Grow-Expansion с отбрасыванием нулей).
+    void add(double value) {
+        double q = value;
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            double h = 0;
+            twoSum(q, terms[i], q, h);
+            if (h != 0) terms[kept++] = h;
+        }
+        if (q != 0) terms[kept++] = q;
+        size = kept;
+    }
+
+    /// Прибавляет произведение (a1 + a0) * (b1 + b0), взятое со знаком sign.
+    void addProduct(double a1, double a0, double b1, double b0, double sign) {
+        for (double a : { a0, a1 }) {
+            for (double b : { b0, b1 }) {
+                double p = a * b;
+                // fma округляет один раз, поэтому даёт точную ошибку произведения.
+                double e = std::fma(a, b, -p);
+                add(sign * e);
+                add(sign * p);
+            }
+        }
+    }
+
+    /// Сумма, округлённая до double: знак совпадает со знаком старшей компоненты.
+    double estimate() const {
+        double sum = 0;
+        for (std::size_t i = 0; i < size; ++i) sum += terms[i];
+        return sum;
+    }
+};
+
+} // namespace
+
+double orient2dExact(const Point_2& a, const Point_2& b, const Point_2& c) {
+    totalFallbacks.fetch_add(1, std::memory_order_relaxed);
+
+    double abx1, abx0, aby1, aby0, acx1, acx0, acy1, acy0;
+    twoDiff(b.x, a.x, abx1, abx0);
+    twoDiff(b.y, a.y, aby1, aby0);
+    twoDiff(c.x, a.x, acx1, acx0);
+    twoDiff(c.y, a.y, acy1, acy0);
+
+    Expansion det;
+    det.addProduct(abx1, abx0, acy1, acy0, 1);
+    det.addProduct(aby1, aby0, acx1, acx0, -1);
+    return det.estimate();
+}
+
+PredicateStats predicateStats() {
+    return { totalFallbacks.load(std::memory_order_relaxed) };
+}
+
+void resetPredicateStats() {
+    totalFallbacks.store(0, std::memory_order_relaxed);
+}
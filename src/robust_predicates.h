@@ -0,0 +1,74 @@
+﻿/**
+ * @file robust_predicates.h
+ * @brief Устойчивый предикат ориентации с фильтром и точным уточнением.
+ *
+ * Решения "по какую сторону прямой лежит точка" при обрезке (clipLine,
+ * PolygonClipper) принимаются по знаку определителя ориентации. В double
+ * он считается с ошибкой, и для почти коллинеарных точек знак может
+ * оказаться неверным: тогда отрезок, задевающий угол области, теряется
+ * или считается пересекающим, а чётность пересечений сбивается.
+ *
+ * orient2d сначала считает определитель обычной арифметикой и сравнивает
+ * его с априорной оценкой ошибки (фильтр Шевчука). Если модуль больше
+ * оценки, знак гарантированно верен и результат возвращается сразу; это
+ * почти все вызовы. Иначе определитель пересчитывается точно: разности
+ * координат и произведения раскладываются в суммы без потерь (two-sum,
+ * two-product через fma), а суммы накапливаются в неперекрывающееся
+ * разложение. Фильтр встроен (inline) в место вызова, и вызовов функций
+ * в нём нет; отдельной функцией вызывается только точный пересчёт, и только
+ * он ведёт счётчик: сколько раз понадобилось уточнение.
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <cmath>
+#include <cstdint>
+
+/// Оценка ошибки определителя ориентации в долях |detLeft| + |detRight| (Шевчук, ccwerrboundA).
+constexpr double ORIENT_ERROR_BOUND = (3.0 + 16.0 * 0x1p-53) * 0x1p-53;
+
+/**
+ * @brief Точное значение определителя ориентации, округлённое до double.
+ *
+ * Вызывается из orient2d, когда фильтр не гарантирует знак; увеличивает
+ * счётчик уточнений.
+ */
+double orient2dExact(const Point_2& a, const Point_2& b, const Point_2& c);
+
+/**
+ * @brief Удвоенная ориентированная площадь треугольника abc с верным знаком.
+ *
+ * Положительна, если c слева от направленной прямой ab, отрицательна, если
+ * справа, и ровно 0 для коллинеарных точек. Когда фильтр проходит,
+ * значение совпадает с (b - a) x (c - a) в double; иначе это округлённое
+ * точное значение.
+ */
+inline double orient2d(const Point_2& a, const Point_2& b, const Point_2& c) {
+    double detLeft = (b.x - a.x) * (c.y - a.y);
+    double detRight = (b.y - a.y) * (c.x - a.x);
+    double det = detLeft - detRight;
+
+    // Одна почти всегда верно предсказанная проверка. Слагаемые разных знаков
+    // проходят её сами: тогда |det| = |detLeft| + |detRight|.
+    if (std::abs(det) >= ORIENT_ERROR_BOUND * (std::abs(detLeft) + std::abs(detRight))) return det;
+    return orient2dExact(a, b, c);
+}
+
+/**
+ * @brief Счётчик точных пересчётов с начала работы или с последнего сброса.
+ *
+ * Вызовы, прошедшие фильтр, не считаются: счётчик на каждый вызов стоил бы
+ * больше самого фильтра.
+ */
+struct PredicateStats {
+    /// Вызовов orient2d, потребовавших точного пересчёта.
+    std::uint64_t fallbacks = 0;
+};
+
+/// Снимок счётчика.
+PredicateStats predicateStats();
+
+/// Обнуляет счётчик.
+void resetPredicateStats();
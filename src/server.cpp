@@ -0,0 +1,498 @@
+﻿/**
+ * @file server.cpp
+ * @brief Реализация сервера штриховки, клиента и генератора нагрузки.
+ */
+
+#include "server.h"
+#include "hatcher.h"
+#include "job_arena.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HATCH_HAS_UNIX_SOCKETS 1
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/// Предельное число линий штриховки (смещений) на один запрос.
+constexpr double MAX_ROWS_PER_REQUEST = 1e7;
+/// Сколько сервер ждёт продолжения кадра, начатого клиентом.
+constexpr std::chrono::seconds STALLED_FRAME_TIMEOUT{ 10 };
+/// Сколько сервер ждёт, пока клиент освободит место для ответа, мс.
+constexpr int WRITE_TIMEOUT_MS = 10000;
+
+/**
+ * @brief Буфер потока вывода, дописывающий в std::string без потери ёмкости.
+ */
+class StringAppendBuffer : public std::streambuf {
+public:
+    explicit StringAppendBuffer(std::string& target) : target_(target) {}
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (ch != traits_type::eof()) target_.push_back(static_cast<char>(ch));
+        return ch;
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize size) override {
+        target_.append(data, static_cast<std::size_t>(size));
+        return size;
+    }
+
+private:
+    std::string& target_;
+};
+
+/**
+ * @brief Буферы рабочего потока, переиспользуемые между запросами.
+ */
+struct WorkerBuffers {
+    std::string output;
+    HatchRequest request;
+    Lines lines;
+    /// Временные структуры штриховки; сбрасывается после каждого запроса.
+    JobArena arena;
+};
+
+/**
+ * @brief Выполняет запрос и кодирует тело ответа в buffers.output.
+ */
+void handleRequest(WorkerBuffers& buffers) {
+    const HatchRequest& request = buffers.request;
+    buffers.lines.clear();
+
+    try {
+        if (!(request.step > 0) || !std::isfinite(request.step) || !std::isfinite(request.angleDegrees))
+            throw std::invalid_argument("step must be a positive number");
+
+        Point_2 bottomLeft{};
+        Point_2 topRight{};
+        if (computeBounds(request.contours, bottomLeft, topRight)) {
+            double extent = std::hypot(topRight.x - bottomLeft.x, topRight.y - bottomLeft.y);
+            if (extent / request.step > MAX_ROWS_PER_REQUEST)
+                throw std::invalid_argument("step is too small for the contour size");
+            hatchContours(request.contours, request.angleDegrees, request.step, buffers.lines, &buffers.arena);
+        }
+
+        encodeResponseHeader(true, request.format, buffers.output);
+        StringAppendBuffer sink(buffers.output);
+        std::ostream out(&sink);
+        if (request.format == OutputFormat::Svg) writeSvg(out, buffers.lines, request.contours);
+        else writeBinary(out, buffers.lines);
+    }
+    catch (const std::exception& e) {
+        encodeResponseHeader(false, request.format, buffers.output);
+        buffers.output += e.what();
+    }
+    buffers.arena.reset();
+}
+
+#ifdef HATCH_HAS_UNIX_SOCKETS
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+extern "C" void onStopSignal(int) { stopRequested = 1; }
+
+bool readFully(int fd, void* data, std::size_t size) {
+    char* target = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = ::read(fd, target, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        target += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void* data, std::size_t size) {
+#ifdef MSG_NOSIGNAL
+    constexpr int flags = MSG_NOSIGNAL;
+#else
+    constexpr int flags = 0;
+#endif
+    const char* source = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::send(fd, source, size, flags);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Неблокирующий сокет сервера: ждём места, но не дольше таймаута.
+            pollfd writable{ fd, POLLOUT, 0 };
+            if (::poll(&writable, 1, WRITE_TIMEOUT_MS) <= 0) return false;
+            continue;
+        }
+        if (n <= 0) return false;
+        source += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool readFrame(int fd, const char (&magic)[4], std::string& body) {
+    char header[4];
+    std::uint64_t size = 0;
+    if (!readFully(fd, header, sizeof header) || !readFully(fd, &size, sizeof size)) return false;
+    if (std::memcmp(header, magic, sizeof header) != 0 || size > MAX_FRAME_BYTES) return false;
+    body.resize(static_cast<std::size_t>(size));
+    return readFully(fd, body.data(), body.size());
+}
+
+bool writeFrame(int fd, const char (&magic)[4], const std::string& body) {
+    std::uint64_t size = body.size();
+    return writeFully(fd, magic, sizeof magic) && writeFully(fd, &size, sizeof size)
+        && writeFully(fd, body.data(), body.size());
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof address.sun_path)
+        throw std::runtime_error("socket path is too long: " + path);
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+/**
+ * @brief Соединение в принимающем потоке: кадр запроса собирается неблокирующим чтением.
+ *
+ * Пулу отдаётся только полностью пришедший запрос, поэтому клиент,
+ * оборвавший кадр на середине, не держит рабочий поток.
+ */
+struct Connection {
+    /// Заголовок кадра: сигнатура и длина тела.
+    char header[sizeof REQUEST_MAGIC + sizeof(std::uint64_t)] = {};
+    /// Прочитано байт кадра (заголовок и тело).
+    std::size_t received = 0;
+    /// Тело запроса; ёмкость сохраняется между запросами.
+    std::string body;
+    /// Запрос у пула: соединение не опрашивается.
+    bool busy = false;
+    /// Когда последний раз пришли байты незаконченного кадра.
+    std::chrono::steady_clock::time_point lastProgress;
+};
+
+enum class FrameState { Partial, Complete, Closed };
+
+/**
+ * @brief Дочитывает доступные байты кадра, не блокируясь.
+ *
+ * Байты следующего кадра не читаются: они остаются в сокете до следующего опроса.
+ */
+FrameState readAvailable(int fd, Connection& connection) {
+    constexpr std::size_t HEADER_BYTES = sizeof Connection::header;
+    for (;;) {
+        char* target = nullptr;
+        std::size_t wanted = 0;
+        if (connection.received < HEADER_BYTES) {
+            target = connection.header + connection.received;
+            wanted = HEADER_BYTES - connection.received;
+        }
+        else {
+            std::size_t bodyReceived = connection.received - HEADER_BYTES;
+            target = connection.body.data() + bodyReceived;
+            wanted = connection.body.size() - bodyReceived;
+        }
+        if (wanted == 0) return FrameState::Complete;
+
+        ssize_t n = ::read(fd, target, wanted);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return FrameState::Partial;
+        if (n <= 0) return FrameState::Closed;
+        connection.received += static_cast<std::size_t>(n);
+        connection.lastProgress = std::chrono::steady_clock::now();
+
+        if (connection.received == HEADER_BYTES) {
+            std::uint64_t size = 0;
+            std::memcpy(&size, connection.header + sizeof REQUEST_MAGIC, sizeof size);
+            if (std::memcmp(connection.header, REQUEST_MAGIC, sizeof REQUEST_MAGIC) != 0 || size > MAX_FRAME_BYTES)
+                return FrameState::Closed;
+            connection.body.resize(static_cast<std::size_t>(size));
+        }
+    }
+}
+
+/**
+ * @brief Соединения, обслуженные пулом и возвращаемые принимающему потоку.
+ *
+ * Возврат будит poll через канал (self-pipe), чтобы следующий запрос
+ * соединения не ждал таймаута опроса.
+ */
+class ReturnQueue {
+public:
+    /// Обслуженное соединение; open == false - его нужно закрыть.
+    struct Returned {
+        int fd;
+        bool open;
+    };
+
+    ReturnQueue() {
+        int fds[2];
+        if (::pipe(fds) < 0) throw std::runtime_error("cannot create wake-up pipe");
+        wakeRead_ = fds[0];
+        wakeWrite_ = fds[1];
+        ::fcntl(wakeRead_, F_SETFL, ::fcntl(wakeRead_, F_GETFL) | O_NONBLOCK);
+        ::fcntl(wakeWrite_, F_SETFL, ::fcntl(wakeWrite_, F_GETFL) | O_NONBLOCK);
+    }
+
+    ~ReturnQueue() {
+        ::close(wakeRead_);
+        ::close(wakeWrite_);
+    }
+
+    ReturnQueue(const ReturnQueue&) = delete;
+    ReturnQueue& operator=(const ReturnQueue&) = delete;
+
+    /// Дескриптор, готовый к чтению, когда есть возвращённые соединения.
+    int wakeFd() const { return wakeRead_; }
+
+    void giveBack(int fd, bool open) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            returned_.push_back({ fd, open });
+        }
+        char signal = 1;
+        [[maybe_unused]] ssize_t n = ::write(wakeWrite_, &signal, 1);
+    }
+
+    /// Забирает возвращённые соединения и очищает канал пробуждения.
+    void takeAll(std::vector<Returned>& out) {
+        char drain[64];
+        while (::read(wakeRead_, drain, sizeof drain) > 0) {}
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.insert(out.end(), returned_.begin(), returned_.end());
+        returned_.clear();
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<Returned> returned_;
+    int wakeRead_ = -1;
+    int wakeWrite_ = -1;
+};
+
+/**
+ * @brief Выполняет пришедший запрос и пишет ответ.
+ *
+ * Соединение возвращается принимающему потоку, а не держит рабочий поток
+ * до отключения клиента: простаивающие keep-alive клиенты не занимают пул.
+ */
+void serveRequest(int fd, const std::string& body, ReturnQueue& done) {
+    thread_local WorkerBuffers buffers;
+
+    if (decodeRequest(body, buffers.request)) {
+        handleRequest(buffers);
+    }
+    else {
+        encodeResponseHeader(false, OutputFormat::Binary, buffers.output);
+        buffers.output += "malformed request";
+    }
+    done.giveBack(fd, writeFrame(fd, RESPONSE_MAGIC, buffers.output));
+}
+
+#endif
+
+} // namespace
+
+#ifdef HATCH_HAS_UNIX_SOCKETS
+
+int runServer(const ServerOptions& options) {
+    sockaddr_un address = socketAddress(options.socketPath);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) throw std::runtime_error("cannot create socket");
+
+    ::unlink(options.socketPath.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof address) < 0
+        || ::listen(listener, SOMAXCONN) < 0) {
+        ::close(listener);
+        throw std::runtime_error("cannot listen on " + options.socketPath + ": " + std::strerror(errno));
+    }
+
+    stopRequested = 0;
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    ReturnQueue done;
+    // Все открытые соединения; закрывает их только этот поток.
+    // Узлы unordered_map не переезжают, так что тело запроса можно читать из пула.
+    std::unordered_map<int, Connection> connections;
+    auto closeConnection = [&](int fd) {
+        connections.erase(fd);
+        ::close(fd);
+    };
+    {
+        ThreadPool pool(options.threads);
+        std::vector<pollfd> waiting;
+        std::vector<ReturnQueue::Returned> returned;
+        std::vector<int> stalled;
+
+        while (!stopRequested) {
+            returned.clear();
+            done.takeAll(returned);
+            for (const auto& r : returned) {
+                if (r.open) connections[r.fd].busy = false;
+                else closeConnection(r.fd);
+            }
+
+            // Кадр, застрявший на середине, закрывается: иначе соединение висит вечно.
+            auto now = std::chrono::steady_clock::now();
+            stalled.clear();
+            for (const auto& [fd, connection] : connections) {
+                if (!connection.busy && connection.received > 0 && now - connection.lastProgress > STALLED_FRAME_TIMEOUT)
+                    stalled.push_back(fd);
+            }
+            for (int fd : stalled) closeConnection(fd);
+
+            waiting.clear();
+            waiting.push_back({ listener, POLLIN, 0 });
+            waiting.push_back({ done.wakeFd(), POLLIN, 0 });
+            for (const auto& [fd, connection] : connections) {
+                if (!connection.busy) waiting.push_back({ fd, POLLIN, 0 });
+            }
+
+            int ready = ::poll(waiting.data(), waiting.size(), 250);
+            if (ready <= 0) continue;
+
+            // Полностью пришедший запрос - отдельная задача пула; до её конца соединение не опрашивается.
+            for (std::size_t i = 2; i < waiting.size(); ++i) {
+                if (!(waiting[i].revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL))) continue;
+                int fd = waiting[i].fd;
+                Connection& connection = connections[fd];
+                FrameState state = readAvailable(fd, connection);
+                if (state == FrameState::Closed) {
+                    closeConnection(fd);
+                }
+                else if (state == FrameState::Complete) {
+                    connection.busy = true;
+                    connection.received = 0;
+                    const std::string* body = &connection.body;
+                    pool.submit([fd, body, &done] { serveRequest(fd, *body, done); });
+                }
+            }
+
+            if (waiting[0].revents & POLLIN) {
+                int client = ::accept(listener, nullptr, nullptr);
+                if (client >= 0) {
+                    ::fcntl(client, F_SETFL, ::fcntl(client, F_GETFL) | O_NONBLOCK);
+                    connections[client];
+                }
+            }
+        }
+
+        ::close(listener);
+        // Будит запросы, ждущие медленного клиента при записи ответа.
+        for (const auto& [fd, connection] : connections) {
+            if (connection.busy) ::shutdown(fd, SHUT_RDWR);
+        }
+        // Деструктор пула дожидается запросов, прерванных shutdown.
+    }
+
+    for (const auto& [fd, connection] : connections) ::close(fd);
+    ::unlink(options.socketPath.c_str());
+    return 0;
+}
+
+HatchClient::HatchClient(const std::string& socketPath) {
+    sockaddr_un address = socketAddress(socketPath);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0) throw std::runtime_error("cannot create socket");
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof address) < 0) {
+        ::close(fd_);
+        throw std::runtime_error("cannot connect to " + socketPath + ": " + std::strerror(errno));
+    }
+}
+
+HatchClient::~HatchClient() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void HatchClient::call(const HatchRequest& request, HatchResponse& response) {
+    encodeRequest(request, buffer_);
+    if (!writeFrame(fd_, REQUEST_MAGIC, buffer_) || !readFrame(fd_, RESPONSE_MAGIC, buffer_))
+        throw std::runtime_error("connection to hatch server lost");
+    if (!decodeResponse(buffer_, response))
+        throw std::runtime_error("malformed response from hatch server");
+}
+
+#else
+
+int runServer(const ServerOptions&) {
+    throw std::runtime_error("server mode requires Unix domain sockets");
+}
+
+HatchClient::HatchClient(const std::string&) {
+    throw std::runtime_error("client mode requires Unix domain sockets");
+}
+
+HatchClient::~HatchClient() = default;
+
+void HatchClient::call(const HatchRequest&, HatchResponse&) {}
+
+#endif
+
+LoadTestReport runLoadTest(const LoadTestOptions& options, const HatchRequest& request) {
+    std::size_t connections = std::max<std::size_t>(1, options.connections);
+    std::atomic<std::size_t> issued{ 0 };
+    std::atomic<std::size_t> errors{ 0 };
+    std::vector<std::vector<std::chrono::microseconds>> latencies(connections);
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::thread> threads;
+        for (std::size_t c = 0; c < connections; ++c) {
+            threads.emplace_back([&, c] {
+                try {
+                    HatchClient client(options.socketPath);
+                    HatchResponse response;
+                    while (issued.fetch_add(1) < options.requests) {
+                        auto sent = std::chrono::steady_clock::now();
+                        client.call(request, response);
+                        latencies[c].push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - sent));
+                        if (!response.ok) ++errors;
+                    }
+                }
+                catch (const std::exception&) {
+                    ++errors;
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+
+    LoadTestReport report;
+    report.elapsed = std::chrono::steady_clock::now() - start;
+    report.errors = errors;
+
+    std::vector<std::chrono::microseconds> all;
+    for (const auto& part : latencies) all.insert(all.end(), part.begin(), part.end());
+    std::sort(all.begin(), all.end());
+    report.completed = all.size();
+    if (!all.empty()) {
+        report.p50 = all[all.size() / 2];
+        report.p99 = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+        report.max = all.back();
+    }
+    return report;
+}
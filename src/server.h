@@ -0,0 +1,105 @@
+﻿/**
+ * @file server.h
+ * @brief Долгоживущий сервер штриховки на Unix-сокете, клиент и генератор нагрузки.
+ *
+ * Сервер принимает соединения на Unix domain socket и обслуживает их пулом
+ * потоков. Соединение может передать несколько запросов подряд. Принимающий
+ * поток опрашивает (poll) простаивающие соединения и собирает кадры
+ * запросов неблокирующим чтением; пулу отдаётся только полностью пришедший
+ * запрос, а после ответа соединение возвращается в опрос. Поэтому молчащие
+ * клиенты и клиенты, оборвавшие кадр на середине, не занимают рабочие
+ * потоки, и их число не ограничено размером пула. Кадр, не дополненный
+ * за 10 секунд, и ответ, который клиент не забирает столько же, закрывают
+ * соединение. Каждый поток
+ * держит свои буферы (контуры, линии, выходной текст), которые после первых
+ * запросов уже имеют нужную ёмкость и не выделяются заново.
+ *
+ * Доступно только на POSIX-системах; на остальных функции бросают исключение.
+ */
+
+#pragma once
+
+#include "protocol.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Параметры сервера.
+ */
+struct ServerOptions {
+    /// Путь к сокету.
+    std::string socketPath;
+    /// Число рабочих потоков; 0 - по числу ядер.
+    std::size_t threads = 0;
+};
+
+/**
+ * @brief Запускает сервер и блокируется до SIGINT/SIGTERM.
+ * @param options Параметры.
+ * @return Код выхода.
+ * @throws std::runtime_error если сокет не удалось создать.
+ */
+int runServer(const ServerOptions& options);
+
+/**
+ * @brief Клиентское соединение с сервером (несколько запросов подряд).
+ */
+class HatchClient {
+public:
+    /**
+     * @brief Подключается к серверу.
+     * @param socketPath Путь к сокету.
+     * @throws std::runtime_error если подключиться не удалось.
+     */
+    explicit HatchClient(const std::string& socketPath);
+    ~HatchClient();
+
+    HatchClient(const HatchClient&) = delete;
+    HatchClient& operator=(const HatchClient&) = delete;
+
+    /**
+     * @brief Отправляет запрос и ждёт ответа.
+     * @param request Запрос.
+     * @param response Ответ.
+     * @throws std::runtime_error при обрыве соединения или повреждённом ответе.
+     */
+    void call(const HatchRequest& request, HatchResponse& response);
+
+private:
+    int fd_ = -1;
+    std::string buffer_;
+};
+
+/**
+ * @brief Параметры генератора нагрузки.
+ */
+struct LoadTestOptions {
+    /// Путь к сокету.
+    std::string socketPath;
+    /// Общее число запросов.
+    std::size_t requests = 1000;
+    /// Число параллельных соединений.
+    std::size_t connections = 4;
+};
+
+/**
+ * @brief Итоги нагрузочного прогона.
+ */
+struct LoadTestReport {
+    std::size_t completed = 0;
+    std::size_t errors = 0;
+    std::chrono::duration<double> elapsed{ 0 };
+    std::chrono::microseconds p50{ 0 };
+    std::chrono::microseconds p99{ 0 };
+    std::chrono::microseconds max{ 0 };
+};
+
+/**
+ * @brief Отправляет один и тот же запрос много раз из нескольких соединений.
+ * @param options Параметры прогона.
+ * @param request Запрос.
+ * @return Итоги: пропускная способность и задержки.
+ */
+LoadTestReport runLoadTest(const LoadTestOptions& options, const HatchRequest& request);
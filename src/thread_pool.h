@@ -0,0 +1,52 @@
+﻿/**
+ * @file thread_pool.h
+ * @brief Пул потоков с общей очередью задач.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Фиксированный пул рабочих потоков.
+ *
+ * Задачи выполняются в порядке поступления. Деструктор дожидается
+ * выполнения всех уже поставленных задач.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Запускает потоки.
+     * @param threads Число потоков; 0 - по числу ядер.
+     */
+    explicit ThreadPool(std::size_t threads = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Ставит задачу в очередь.
+     * @param task Задача.
+     */
+    void submit(std::function<void()> task);
+
+    /// Число рабочих потоков.
+    std::size_t size() const { return workers_.size(); }
+
+private:
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
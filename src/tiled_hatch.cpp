@@ -0,0 +1,126 @@
+﻿/**
+ * @file tiled_hatch.cpp
+ * @brief Реализация штриховки по плиткам.
+ */
+
+#include "tiled_hatch.h"
+
+#include "edge_index.h"
+#include "hatcher.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+/// Квантование угла для общего индекса рёбер: микроградусы.
+constexpr double ANGLE_QUANTUM = 1e6;
+
+struct Tile {
+    Point_2 low;
+    Point_2 high;
+    const EdgeIndex* index;
+    Lines lines;
+};
+
+/// Штрихует одну плитку: строки индекса, попадающие в плитку, обрезанные по ней.
+void hatchTile(Tile& tile, double step) {
+    const EdgeIndex& index = *tile.index;
+    const Point_2& perp = index.normal();
+
+    auto offsetOf = [&](double x, double y) { return perp.x * x + perp.y * y; };
+    auto [lowV, highV] = std::minmax({ offsetOf(tile.low.x, tile.low.y), offsetOf(tile.high.x, tile.low.y),
+                                       offsetOf(tile.low.x, tile.high.y), offsetOf(tile.high.x, tile.high.y) });
+    // Смещения k * step, как в hatchWithIndex: у плиток с одним углом строки совпадают.
+    double first = std::ceil(std::max(lowV, index.minOffset()) / step);
+    double last = std::floor(std::min(highV, index.maxOffset()) / step);
+
+    std::pmr::vector<double> crossings;
+    Lines row;
+    bool reverse = false;
+    for (double k = first; k <= last; ++k) {
+        row.clear();
+        hatchRow(index, k * step, crossings, row);
+
+        std::size_t begin = tile.lines.size();
+        for (auto line : row) {
+            if (clipLine(line, tile.low, tile.high)) tile.lines.push_back(line);
+        }
+        if (tile.lines.size() == begin) continue;
+
+        // Змейка: каждая вторая непустая строка проходится в обратную сторону.
+        if (reverse) {
+            std::reverse(tile.lines.begin() + static_cast<std::ptrdiff_t>(begin), tile.lines.end());
+            for (auto it = tile.lines.begin() + static_cast<std::ptrdiff_t>(begin); it != tile.lines.end(); ++it)
+                std::swap(it->start, it->end);
+        }
+        reverse = !reverse;
+    }
+}
+
+} // namespace
+
+void hatchTiled(const Contours& contours, double angleDegrees, double step, const TilingOptions& options,
+    Lines& lines, TilingStats* stats) {
+    if (!(options.size > 0)) throw std::invalid_argument("Tile size must be positive");
+
+    TilingStats local;
+    Point_2 low{};
+    Point_2 high{};
+    if (!computeBounds(contours, low, high)) {
+        if (stats) *stats = local;
+        return;
+    }
+
+    auto columns = static_cast<std::size_t>(std::ceil((high.x - low.x) / options.size));
+    auto rows = options.mode == TileMode::Stripes
+        ? std::size_t{ 1 } : static_cast<std::size_t>(std::ceil((high.y - low.y) / options.size));
+    columns = std::max<std::size_t>(columns, 1);
+    rows = std::max<std::size_t>(rows, 1);
+
+    // Индексы рёбер строятся заранее, в этом потоке; плитки только читают их.
+    std::map<std::int64_t, std::unique_ptr<EdgeIndex>> indexes;
+    auto indexFor = [&](double angle) {
+        double normalized = normalizeHatchAngle(angle);
+        auto& index = indexes[std::llround(normalized * ANGLE_QUANTUM)];
+        if (!index) index = std::make_unique<EdgeIndex>(contours, normalized);
+        return index.get();
+    };
+
+    // Порядок обхода: ряды снизу вверх, в ряду - змейкой.
+    std::vector<Tile> tiles;
+    tiles.reserve(columns * rows);
+    for (std::size_t j = 0; j < rows; ++j) {
+        for (std::size_t n = 0; n < columns; ++n) {
+            std::size_t i = j % 2 == 0 ? n : columns - 1 - n;
+            Tile tile;
+            tile.low = { low.x + static_cast<double>(i) * options.size,
+                         options.mode == TileMode::Stripes ? low.y : low.y + static_cast<double>(j) * options.size };
+            tile.high = { std::min(tile.low.x + options.size, high.x),
+                          options.mode == TileMode::Stripes ? high.y : std::min(tile.low.y + options.size, high.y) };
+            tile.index = indexFor(angleDegrees + options.rotation * static_cast<double>(i + j));
+            tiles.push_back(std::move(tile));
+        }
+    }
+
+    {
+        ThreadPool pool(std::min(options.threads, tiles.size()));
+        for (auto& tile : tiles)
+            pool.submit([&tile, step] { hatchTile(tile, step); });
+        // Деструктор пула дожидается всех плиток.
+    }
+
+    for (const auto& tile : tiles) {
+        if (tile.lines.empty()) ++local.emptyTiles;
+        lines.insert(lines.end(), tile.lines.begin(), tile.lines.end());
+    }
+    local.tiles = tiles.size();
+    local.angles = indexes.size();
+    if (stats) *stats = local;
+}
@@ -0,0 +1,69 @@
+﻿/**
+ * @file tiled_hatch.h
+ * @brief Штриховка по плиткам: полосы и шахматная доска.
+ *
+ * Для крупных деталей лазер сканирует область частями: рамка контура делится
+ * на полосы или квадраты, и каждая плитка штрихуется своим углом, чтобы
+ * остаточные напряжения не складывались вдоль одного направления.
+ *
+ * Угол плитки (i, j) - angle + rotation * (i + j) по модулю 180 (при
+ * rotation = 90 соседние плитки чередуют направление). Индекс рёбер строится
+ * один раз на каждый встретившийся угол, а плитки штрихуются независимо
+ * в пуле потоков: линия индекса обрезается по контуру (правило чётности),
+ * затем по прямоугольнику плитки (clipLine). Внутри плитки строки идут
+ * змейкой, сами плитки - по рядам снизу вверх, тоже змейкой.
+ */
+
+#pragma once
+
+#include "geometry.h"
+
+#include <cstddef>
+
+/**
+ * @brief Способ деления рамки на плитки.
+ */
+enum class TileMode {
+    /// Вертикальные полосы шириной size на всю высоту рамки.
+    Stripes,
+    /// Квадраты size x size.
+    Chessboard
+};
+
+/**
+ * @brief Параметры деления на плитки.
+ */
+struct TilingOptions {
+    TileMode mode = TileMode::Chessboard;
+    /// Ширина полосы или сторона квадрата.
+    double size = 5;
+    /// Поворот угла штриховки между соседними плитками, градусы.
+    double rotation = 90;
+    /// Потоки штриховки плиток; 0 - по числу ядер.
+    std::size_t threads = 0;
+};
+
+/**
+ * @brief Итоги штриховки по плиткам.
+ */
+struct TilingStats {
+    /// Плиток в рамке.
+    std::size_t tiles = 0;
+    /// Плиток без линий (вне контура).
+    std::size_t emptyTiles = 0;
+    /// Различных углов (построенных индексов рёбер).
+    std::size_t angles = 0;
+};
+
+/**
+ * @brief Штрихует область (правило чётности) по плиткам.
+ * @param contours Контуры.
+ * @param angleDegrees Угол штриховки первой плитки.
+ * @param step Шаг штриховки.
+ * @param options Параметры плиток.
+ * @param lines Выходные линии в порядке прохода (дописываются).
+ * @param stats Итоги (необязательно).
+ * @throws std::invalid_argument если размер плитки не положителен.
+ */
+void hatchTiled(const Contours& contours, double angleDegrees, double step, const TilingOptions& options,
+    Lines& lines, TilingStats* stats = nullptr);
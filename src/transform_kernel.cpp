@@ -0,0 +1,73 @@
+﻿/**
+ * @file transform_kernel.cpp
+ * @brief Реализация векторных преобразований.
+ */
+
+#include "transform_kernel.h"
+
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#define HATCH_HAVE_SIMD 1
+#endif
+
+namespace {
+
+#ifdef HATCH_HAVE_SIMD
+namespace stdx = std::experimental;
+using Batch = stdx::native_simd<double>;
+constexpr std::size_t LANES = Batch::size();
+#else
+constexpr std::size_t LANES = 1;
+#endif
+
+/// Начало скалярного хвоста: число значений, кратное ширине вектора.
+std::size_t vectorEnd(std::size_t count) { return count - count % LANES; }
+
+template <bool Translate>
+void transformRange(const Transform2& t, double* x, double* y, std::size_t count) {
+    std::size_t i = 0;
+#ifdef HATCH_HAVE_SIMD
+    for (std::size_t end = vectorEnd(count); i < end; i += LANES) {
+        Batch px(x + i, stdx::element_aligned);
+        Batch py(y + i, stdx::element_aligned);
+        Batch rx = t.xx * px + t.xy * py;
+        Batch ry = t.yx * px + t.yy * py;
+        if constexpr (Translate) {
+            rx += t.tx;
+            ry += t.ty;
+        }
+        rx.copy_to(x + i, stdx::element_aligned);
+        ry.copy_to(y + i, stdx::element_aligned);
+    }
+#endif
+    for (; i < count; ++i) {
+        double rx = t.xx * x[i] + t.xy * y[i];
+        double ry = t.yx * x[i] + t.yy * y[i];
+        if constexpr (Translate) {
+            rx += t.tx;
+            ry += t.ty;
+        }
+        x[i] = rx;
+        y[i] = ry;
+    }
+}
+
+} // namespace
+
+void transformPoints(const Transform2& transform, double* x, double* y, std::size_t count) {
+    // Прибавление нуля превратило бы -0 в +0: без сдвига оно не выполняется.
+    if (transform.tx == 0 && transform.ty == 0) transformRange<false>(transform, x, y, count);
+    else transformRange<true>(transform, x, y, count);
+}
+
+void scaleValues(const double* in, double* out, std::size_t count, double scale) {
+    std::size_t i = 0;
+#ifdef HATCH_HAVE_SIMD
+    for (std::size_t end = vectorEnd(count); i < end; i += LANES) {
+        Batch v(in + i, stdx::element_aligned);
+        v *= scale;
+        v.copy_to(out + i, stdx::element_aligned);
+    }
+#endif
+    for (; i < count; ++i) out[i] = in[i] * scale;
+}